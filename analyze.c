@@ -0,0 +1,246 @@
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "engine.h"
+#include "threadpool.h"
+
+/* Scores positions in bulk: move sequences (columns 1-7, one per line,
+ * "-" for the empty board) from a file or stdin, searched on every core.
+ * Each output line is the input line's moves, the best column, its score,
+ * the depth and the score of every column ("-" if full, "?" if the time
+ * ran out before it was scored), in input order.
+ * Only ANALYZE_WINDOW lines are in memory at a time, however long the input.
+ * Usage: analyze [file] [--depth N] [--ms N] [--threads N] */
+
+#define ANALYZE_WINDOW 4096
+#define ANALYZE_DEFAULT_DEPTH 10
+#define ANALYZE_MAX_LINE 256
+
+enum { SLOT_QUEUED, SLOT_RUNNING, SLOT_DONE };
+
+typedef struct {
+    char moves[ANALYZE_MAX_LINE];
+    int state;
+    bool valid;
+    int bestCol;
+    int score;
+    int depth;
+    int columnScores[cols];
+    bool playable[cols];
+    bool scored[cols];
+} AnalyzeSlot;
+
+/* The main thread reads lines into the window and writes results out in
+ * order; workers take lines in between. Line n lives in slot n % window,
+ * and everything is guarded by lock. */
+typedef struct {
+    AnalyzeSlot *slots;
+    long long read;             /* lines read so far */
+    long long taken;            /* lines a worker has started */
+    long long written;          /* lines written out */
+    bool inputDone;
+    int depth;
+    int budgetMs;
+    pthread_mutex_t lock;
+    pthread_cond_t work;        /* a line was read, or the input ended */
+    pthread_cond_t done;        /* a line was analysed */
+} Analysis;
+
+typedef struct {
+    Analysis *an;
+    TranspositionTable tt;
+} AnalyzeWorker;
+
+/* plays a line of digits; false if a move is illegal or the game is over */
+static bool parseMoves(const char *moves, Position *pos) {
+    positionInit(pos);
+    if (strcmp(moves, "-") == 0) return true;
+    for (const char *m = moves; *m; m++) {
+        int col = *m - '1';
+        if (col < 0 || col >= cols || !canPlay(pos, col) || isWinningMove(pos, col)) return false;
+        playMove(pos, col);
+    }
+    return !positionFull(pos);
+}
+
+/* The root search gives the best column, its score and the depth; every
+ * column is then searched one ply shallower with a full window, from the
+ * same side as the root so the scores compare. The columns start from a
+ * cleared table, so nothing an aborted root iteration left behind leaks
+ * into them. The root gets half the budget and the columns the rest. */
+static void analyzePosition(AnalyzeWorker *w, AnalyzeSlot *slot) {
+    Analysis *an = w->an;
+    Position pos;
+    slot->valid = parseMoves(slot->moves, &pos);
+    if (!slot->valid) return;
+
+    SearchContext ctx;
+    searchInit(&ctx, &w->tt);
+    long long deadline = deadlineAfterMs(an->budgetMs);
+    SearchResult root = iterativeDeepening(&ctx, &pos, an->depth, an->budgetMs > 1 ? an->budgetMs / 2 : 1);
+    slot->bestCol = root.bestCol;
+    slot->score = root.score;
+    slot->depth = root.depth;
+
+    /* at least one ply, so a child sees a win the opponent has right away,
+     * as the root's threat scan did */
+    int childDepth = root.depth > 1 ? root.depth - 1 : 1;
+    atomic_bool stop = false;
+    ttClear(&w->tt);
+    ctx.stop = &stop;
+    ctx.deadline = deadline;
+    ctx.botColour = pos.moves & 1;
+    ctx.followPv = false;
+    for (int col = 0; col < cols; col++) {
+        slot->playable[col] = canPlay(&pos, col);
+        slot->scored[col] = false;
+        if (!slot->playable[col]) continue;
+        int score;
+        if (isWinningMove(&pos, col)) {
+            score = WIN_SCORE;
+        } else {
+            playMove(&pos, col);
+            score = -negamax(&ctx, &pos, childDepth, INT_MIN + 1, INT_MAX - 1, NULL);
+            undoMove(&pos, col);
+            if (searchStopped(&ctx)) continue;
+        }
+        slot->columnScores[col] = score;
+        slot->scored[col] = true;
+    }
+}
+
+static void workerMain(void *arg) {
+    AnalyzeWorker *w = arg;
+    Analysis *an = w->an;
+    pthread_mutex_lock(&an->lock);
+    while (true) {
+        while (an->taken == an->read && !an->inputDone) pthread_cond_wait(&an->work, &an->lock);
+        if (an->taken == an->read) break;
+        AnalyzeSlot *slot = &an->slots[an->taken++ % ANALYZE_WINDOW];
+        slot->state = SLOT_RUNNING;
+        pthread_mutex_unlock(&an->lock);
+        analyzePosition(w, slot);
+        pthread_mutex_lock(&an->lock);
+        slot->state = SLOT_DONE;
+        pthread_cond_signal(&an->done);
+    }
+    pthread_mutex_unlock(&an->lock);
+}
+
+static void writeSlot(const AnalyzeSlot *slot) {
+    if (!slot->valid) {
+        printf("%s invalid\n", slot->moves);
+        return;
+    }
+    printf("%s %d %d %d", slot->moves, slot->bestCol + 1, slot->score, slot->depth);
+    for (int col = 0; col < cols; col++) {
+        if (!slot->playable[col]) printf(" -");
+        else if (!slot->scored[col]) printf(" ?");
+        else printf(" %d", slot->columnScores[col]);
+    }
+    printf("\n");
+}
+
+/* reads the next position into moves; false at the end of the input */
+static bool readLine(FILE *in, char moves[ANALYZE_MAX_LINE]) {
+    char line[ANALYZE_MAX_LINE];
+    while (fgets(line, sizeof(line), in)) {
+        size_t n = strcspn(line, " \t\r\n");
+        bool whole = strchr(line, '\n') || feof(in);
+        /* too long for any board: swallow the rest and report it invalid */
+        if (!whole) {
+            int c;
+            while ((c = fgetc(in)) != EOF && c != '\n');
+        }
+        if (line[0] == '#' || n == 0) continue;
+        line[n] = '\0';
+        snprintf(moves, ANALYZE_MAX_LINE, "%s", whole ? line : "?");
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    int depth = ANALYZE_DEFAULT_DEPTH, budgetMs = INT_MAX / 2;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) depth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--ms") == 0 && i + 1 < argc) budgetMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else path = argv[i];
+    }
+    if (depth < 1 || depth > MAX_DEPTH || budgetMs <= 0) {
+        printf("Usage: %s [file] [--depth 1-%d] [--ms N] [--threads N]\n", argv[0], MAX_DEPTH);
+        return 1;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > POOL_QUEUE_SIZE) threads = POOL_QUEUE_SIZE;
+
+    FILE *in = stdin;
+    if (path && !(in = fopen(path, "r"))) { perror("fopen"); return 1; }
+
+    engineInit();
+    Analysis an = { .depth = depth, .budgetMs = budgetMs };
+    an.slots = calloc(ANALYZE_WINDOW, sizeof(AnalyzeSlot));
+    AnalyzeWorker *workers = calloc(threads, sizeof(AnalyzeWorker));
+    if (!an.slots || !workers) { printf("Out of memory.\n"); return 1; }
+    for (int i = 0; i < threads; i++) {
+        workers[i].an = &an;
+        if (!ttInit(&workers[i].tt, TT_DEFAULT_BITS)) { printf("Not enough memory for the transposition tables.\n"); return 1; }
+    }
+    pthread_mutex_init(&an.lock, NULL);
+    pthread_cond_init(&an.work, NULL);
+    pthread_cond_init(&an.done, NULL);
+
+    ThreadPool pool;
+    if (!poolInit(&pool, threads, -1)) { printf("Could not start the worker threads.\n"); return 1; }
+    for (int i = 0; i < threads; i++) poolSubmit(&pool, workerMain, &workers[i]);
+
+    /* read while the window has room, write whatever is finished in order,
+     * and wait only when neither can go on */
+    pthread_mutex_lock(&an.lock);
+    while (!an.inputDone || an.written < an.read) {
+        bool progress = false;
+        while (!an.inputDone && an.read - an.written < ANALYZE_WINDOW) {
+            AnalyzeSlot *slot = &an.slots[an.read % ANALYZE_WINDOW];
+            pthread_mutex_unlock(&an.lock);
+            bool more = readLine(in, slot->moves);
+            pthread_mutex_lock(&an.lock);
+            if (more) {
+                slot->state = SLOT_QUEUED;
+                an.read++;
+            } else {
+                an.inputDone = true;
+            }
+            pthread_cond_signal(&an.work);
+            progress = true;
+        }
+        if (an.inputDone) pthread_cond_broadcast(&an.work);
+        while (an.written < an.read && an.slots[an.written % ANALYZE_WINDOW].state == SLOT_DONE) {
+            AnalyzeSlot *slot = &an.slots[an.written % ANALYZE_WINDOW];
+            pthread_mutex_unlock(&an.lock);
+            writeSlot(slot);
+            pthread_mutex_lock(&an.lock);
+            an.written++;
+            progress = true;
+        }
+        if (!progress) pthread_cond_wait(&an.done, &an.lock);
+    }
+    pthread_mutex_unlock(&an.lock);
+
+    poolWait(&pool);
+    poolFree(&pool);
+    for (int i = 0; i < threads; i++) ttFree(&workers[i].tt);
+    free(workers);
+    free(an.slots);
+    pthread_mutex_destroy(&an.lock);
+    pthread_cond_destroy(&an.work);
+    pthread_cond_destroy(&an.done);
+    if (in != stdin) fclose(in);
+    return 0;
+}
@@ -0,0 +1,256 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Board geometry, fixed at compile time; a translation unit may define its
+ * own before including this (see variant.h) to get an engine for another
+ * board. CONNECT is the line length that wins, 3 to 7. */
+#ifndef rows
+#define rows 6
+#endif
+#ifndef cols
+#define cols 7
+#endif
+#ifndef CONNECT
+#define CONNECT 4
+#endif
+
+#if CONNECT < 3 || CONNECT > 7 || CONNECT > rows || CONNECT > cols
+#error "unsupported board geometry"
+#endif
+
+/* ---------- Bitboard layout ----------
+ * Each column uses rows + 1 bits, bottom cell first; the extra bit on top of
+ * every column stays empty so shifts never wrap from one column into the next.
+ *
+ *   6 13 20 27 34 41 48
+ *   5 12 19 26 33 40 47
+ *   ...
+ *   0  7 14 21 28 35 42
+ */
+#define BB_H (rows + 1)
+#define BB_BITS (BB_H * cols)
+
+/* boards past 64 bits (9x7, 10x8) take a 128-bit integer */
+#if BB_BITS <= 64
+typedef uint64_t bitboard;
+#else
+typedef unsigned __int128 bitboard;
+#endif
+
+typedef struct {
+    bitboard current;   /* stones of the side to move */
+    bitboard mask;      /* every occupied cell */
+    uint64_t hash;      /* Zobrist key of the stones on the board */
+    int height[cols];   /* stones already in each column */
+    int moves;          /* plies played so far */
+} Position;
+
+/* Zobrist keys per colour and cell, filled in by engineInit(); the first
+ * player's stones use colour 0, so the mover's colour is moves & 1 */
+extern uint64_t zobristKeys[2][BB_H * cols];
+
+static inline int bbPopcount(bitboard b) {
+#if BB_BITS <= 64
+    return __builtin_popcountll(b);
+#else
+    return __builtin_popcountll((uint64_t)b) + __builtin_popcountll((uint64_t)(b >> 64));
+#endif
+}
+
+/* index of the lowest set bit, b must not be 0 */
+static inline int bbLowest(bitboard b) {
+#if BB_BITS <= 64
+    return __builtin_ctzll(b);
+#else
+    return (uint64_t)b ? __builtin_ctzll((uint64_t)b) : 64 + __builtin_ctzll((uint64_t)(b >> 64));
+#endif
+}
+
+static inline bitboard bottomMaskCol(int col) { return (bitboard)1 << (col * BB_H); }
+static inline bitboard topMaskCol(int col) { return (bitboard)1 << (rows - 1 + col * BB_H); }
+static inline bitboard columnMask(int col) { return (((bitboard)1 << rows) - 1) << (col * BB_H); }
+static inline bitboard cellBit(int row, int col) { return (bitboard)1 << (col * BB_H + row); }
+
+static inline bitboard bottomMask(void) {
+    bitboard b = 0;
+    for (int c = 0; c < cols; c++) b |= bottomMaskCol(c);
+    return b;
+}
+
+static inline bitboard boardMask(void) { return bottomMask() * (((bitboard)1 << rows) - 1); }
+
+/* cells starting a run of CONNECT stones towards higher bits, s apart:
+ * runs of two, then two overlapping runs of two or of four */
+static inline bitboard lineStarts(bitboard b, int s) {
+    bitboard m = b & (b >> s);
+#if CONNECT <= 4
+    return m & (m >> ((CONNECT - 2) * s));
+#else
+    m &= m >> (2 * s);
+    return m & (m >> ((CONNECT - 4) * s));
+#endif
+}
+
+/* true if the given stones contain CONNECT in a row in any direction */
+static inline bool hasLine(bitboard b) {
+    return lineStarts(b, BB_H) ||       /* horizontal */
+           lineStarts(b, BB_H - 1) ||   /* diagonal \ */
+           lineStarts(b, BB_H + 1) ||   /* diagonal / */
+           lineStarts(b, 1);            /* vertical */
+}
+
+static inline void positionInit(Position *pos) {
+    pos->current = 0;
+    pos->mask = 0;
+    pos->hash = 0;
+    for (int c = 0; c < cols; c++) pos->height[c] = 0;
+    pos->moves = 0;
+}
+
+static inline bool canPlay(const Position *pos, int col) {
+    return col >= 0 && col < cols && pos->height[col] < rows;
+}
+
+/* bit of the cell a stone dropped in col would land on */
+static inline bitboard moveBit(const Position *pos, int col) {
+    return (bitboard)1 << (col * BB_H + pos->height[col]);
+}
+
+/* columns that still have room, one bit per column */
+static inline unsigned playableColumns(const Position *pos) {
+    bitboard open = ~pos->mask & (bottomMask() << (rows - 1));
+    unsigned cs = 0;
+    for (int c = 0; c < cols; c++)
+        if (open & topMaskCol(c)) cs |= 1u << c;
+    return cs;
+}
+
+/* every cell that can be played right now */
+static inline bitboard possibleMoves(const Position *pos) {
+    return (pos->mask + bottomMask()) & boardMask();
+}
+
+/* empty cells that would complete a line for the given stones */
+static inline bitboard winningCells(bitboard stones, bitboard mask) {
+    bitboard r;
+#if CONNECT == 4
+    bitboard p;
+    /* vertical: three stones right below */
+    r = (stones << 1) & (stones << 2) & (stones << 3);
+
+    /* horizontal and both diagonals: the cell can sit in any of the four slots */
+    static const int shifts[3] = { BB_H, BB_H - 1, BB_H + 1 };
+    for (int d = 0; d < 3; d++) {
+        int s = shifts[d];
+        p = (stones << s) & (stones << (2 * s));
+        r |= p & (stones << (3 * s));
+        r |= p & (stones >> s);
+        p = (stones >> s) & (stones >> (2 * s));
+        r |= p & (stones << s);
+        r |= p & (stones >> (3 * s));
+    }
+#else
+    /* vertical: a full line less one right below */
+    r = ~(bitboard)0;
+    for (int k = 1; k < CONNECT; k++) r &= stones << k;
+
+    /* the cell takes slot i of the line, the stones fill the others */
+    static const int shifts[3] = { BB_H, BB_H - 1, BB_H + 1 };
+    for (int d = 0; d < 3; d++) {
+        int s = shifts[d];
+        for (int i = 0; i < CONNECT; i++) {
+            bitboard line = ~(bitboard)0;
+            for (int k = -i; k < CONNECT - i; k++) {
+                if (k < 0) line &= stones << (-k * s);
+                if (k > 0) line &= stones >> (k * s);
+            }
+            r |= line;
+        }
+    }
+#endif
+    return r & (boardMask() ^ mask);
+}
+
+static inline bitboard opponentWinningCells(const Position *pos) {
+    return winningCells(pos->current ^ pos->mask, pos->mask);
+}
+
+static inline bool canWinNext(const Position *pos) {
+    return winningCells(pos->current, pos->mask) & possibleMoves(pos);
+}
+
+/* Playable cells that do not hand the opponent an immediate win: a forced
+ * block if there is one, and never the cell right below an opponent
+ * threat. Empty if every move loses. Only meaningful when the side to
+ * move cannot win at once. */
+static inline bitboard nonLosingMoves(const Position *pos) {
+    bitboard possible = possibleMoves(pos);
+    bitboard threats = opponentWinningCells(pos);
+    bitboard forced = possible & threats;
+    if (forced) {
+        if (forced & (forced - 1)) return 0;
+        possible = forced;
+    }
+    return possible & ~(threats >> 1);
+}
+
+static inline bool isWinningMove(const Position *pos, int col) {
+    return hasLine(pos->current | moveBit(pos, col));
+}
+
+/* true if the side not to move would win by dropping a stone in col */
+static inline bool isOpponentWinningMove(const Position *pos, int col) {
+    return hasLine((pos->current ^ pos->mask) | moveBit(pos, col));
+}
+
+/* drops a stone for the side to move, after which the other side is to move */
+static inline void playMove(Position *pos, int col) {
+    bitboard move = moveBit(pos, col);
+    pos->hash ^= zobristKeys[pos->moves & 1][col * BB_H + pos->height[col]];
+    pos->current ^= pos->mask;
+    pos->mask |= move;
+    pos->height[col]++;
+    pos->moves++;
+}
+
+/* takes back the last stone in col; only valid for the most recent move */
+static inline void undoMove(Position *pos, int col) {
+    pos->height[col]--;
+    pos->moves--;
+    bitboard move = moveBit(pos, col);
+    pos->mask ^= move;
+    pos->current ^= pos->mask;
+    pos->hash ^= zobristKeys[pos->moves & 1][col * BB_H + pos->height[col]];
+}
+
+static inline bool positionFull(const Position *pos) { return pos->moves == rows * cols; }
+
+/* stones of the side that just moved */
+static inline bitboard lastMover(const Position *pos) { return pos->current ^ pos->mask; }
+
+/* builds a position from a display board; toMove becomes pos->current */
+static inline void positionFromBoard(Position *pos, char board[rows][cols], char toMove) {
+    positionInit(pos);
+    for (int c = 0; c < cols; c++) {
+        for (int r = 0; r < rows; r++) {
+            char cell = board[rows - 1 - r][c];
+            if (cell == '.') break;
+            bitboard b = cellBit(r, c);
+            pos->mask |= b;
+            if (cell == toMove) pos->current |= b;
+            pos->height[c]++;
+            pos->moves++;
+        }
+    }
+    for (int c = 0; c < cols; c++) {
+        for (int r = 0; r < pos->height[c]; r++) {
+            int colour = (pos->current & cellBit(r, c)) ? (pos->moves & 1) : !(pos->moves & 1);
+            pos->hash ^= zobristKeys[colour][c * BB_H + r];
+        }
+    }
+}
+
+#endif
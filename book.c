@@ -0,0 +1,85 @@
+#include <fcntl.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "book.h"
+
+static bitboard mirrorBoard(bitboard b) {
+    bitboard m = 0;
+    for (int c = 0; c < cols; c++)
+        m |= ((b >> (c * BB_H)) & columnMask(0)) << ((cols - 1 - c) * BB_H);
+    return m;
+}
+
+/* current + mask is unique: within a column it is the side-to-move stones
+ * plus 2^height - 1, and the ranges for different heights do not overlap */
+uint64_t bookKey(const Position *pos, bool *mirrored) {
+    uint64_t key = pos->current + pos->mask;
+    uint64_t flipped = mirrorBoard(pos->current) + mirrorBoard(pos->mask);
+    *mirrored = flipped < key;
+    return *mirrored ? flipped : key;
+}
+
+bool bookOpen(Book *book, const char *path) {
+    *book = (Book){0};
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(BookHeader)) { close(fd); return false; }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    const BookHeader *h = map;
+    if (h->magic != BOOK_MAGIC || h->byteOrder != BOOK_BYTE_ORDER || h->version != BOOK_VERSION ||
+        h->boardRows != rows || h->boardCols != cols ||
+        h->count > ((size_t)st.st_size - sizeof(BookHeader)) / sizeof(BookEntry)) {
+        munmap(map, st.st_size);
+        return false;
+    }
+
+    book->map = map;
+    book->mapSize = st.st_size;
+    book->entries = (const BookEntry *)((const char *)map + sizeof(BookHeader));
+    book->count = h->count;
+    return true;
+}
+
+void bookClose(Book *book) {
+    if (book->map) munmap(book->map, book->mapSize);
+    *book = (Book){0};
+}
+
+static bool probe(const Book *book, const Position *pos, bool exactOnly, int *bestCol, int *score) {
+    if (!book->entries) return false;
+    bool mirrored;
+    uint64_t key = bookKey(pos, &mirrored);
+
+    uint64_t lo = 0, hi = book->count;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (book->entries[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == book->count || book->entries[lo].key != key) return false;
+
+    const BookEntry *e = &book->entries[lo];
+    if (exactOnly && !(e->flags & BOOK_EXACT)) return false;
+    int col = e->bestCol;
+    if (mirrored) col = cols - 1 - col;
+    if (!canPlay(pos, col)) return false;
+    *bestCol = col;
+    *score = e->score;
+    return true;
+}
+
+bool bookProbe(const Book *book, const Position *pos, int *bestCol, int *score) {
+    return probe(book, pos, false, bestCol, score);
+}
+
+bool bookProbeExact(const Book *book, const Position *pos, int *bestCol, int *score) {
+    return probe(book, pos, true, bestCol, score);
+}
@@ -0,0 +1,54 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <stddef.h>
+
+#include "bitboard.h"
+
+#define BOOK_DEFAULT_PATH "opening.book"
+#define BOOK_MAGIC 0x4B423443u      /* "C4BK" */
+#define BOOK_VERSION 1
+#define BOOK_BYTE_ORDER 0x01020304u
+
+/* On-disk layout: one BookHeader followed by `count` BookEntry records
+ * sorted by key, in the byte order of the machine that wrote them. */
+typedef struct {
+    uint32_t magic;
+    uint32_t byteOrder;
+    uint16_t version;
+    uint8_t boardRows, boardCols;
+    uint32_t maxPly;                /* every position with up to this many stones; past it,
+                                     * only Perfect's own (bookgen --horizon) */
+    uint64_t count;
+} BookHeader;
+
+typedef struct {
+    uint64_t key;                   /* bookKey() of the position */
+    int32_t score;                  /* for the side to move */
+    uint8_t bestCol;                /* in the orientation the key was taken from */
+    uint8_t depth;                  /* search depth behind the score */
+    uint8_t flags;                  /* BOOK_EXACT */
+    uint8_t reserved;
+} BookEntry;
+
+/* score and move come from the solver (solver.h), not a depth-limited search */
+#define BOOK_EXACT 0x01
+
+typedef struct {
+    void *map;
+    size_t mapSize;
+    const BookEntry *entries;
+    uint64_t count;
+} Book;
+
+/* unique key of the position or its mirror image, whichever is smaller;
+ * *mirrored tells which one it was */
+uint64_t bookKey(const Position *pos, bool *mirrored);
+
+bool bookOpen(Book *book, const char *path);
+void bookClose(Book *book);
+bool bookProbe(const Book *book, const Position *pos, int *bestCol, int *score);
+/* as bookProbe, but only entries marked BOOK_EXACT, with solver scores */
+bool bookProbeExact(const Book *book, const Position *pos, int *bestCol, int *score);
+
+#endif
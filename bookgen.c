@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+#include "book.h"
+#include "solver.h"
+
+/* Builds the opening book: every position with up to `plies` stones that
+ * is still in play, mirror images merged, each searched to `depth`. With
+ * --exact each one is solved instead (depth and time are ignored) and
+ * marked BOOK_EXACT, the only entries Perfect plays; the deepest plies go
+ * first so the shallower ones find their results in the solver table.
+ * --horizon N then also solves the positions past `plies`, up to N stones,
+ * that Perfect can meet on its turn, where it is too slow to solve live.
+ * Usage: bookgen [book_file] [plies] [depth] [max_ms_per_position] [--exact [--horizon N]] */
+
+typedef struct {
+    uint64_t key;
+    bool mirrored;
+    Position pos;
+} BookNode;
+
+static int compareNodes(const void *a, const void *b) {
+    uint64_t x = ((const BookNode *)a)->key, y = ((const BookNode *)b)->key;
+    return (x > y) - (x < y);
+}
+
+static int compareEntries(const void *a, const void *b) {
+    uint64_t x = ((const BookEntry *)a)->key, y = ((const BookEntry *)b)->key;
+    return (x > y) - (x < y);
+}
+
+/* sorts by key and drops duplicates, returns the new count */
+static size_t uniqueNodes(BookNode *nodes, size_t n) {
+    if (n == 0) return 0;
+    qsort(nodes, n, sizeof(BookNode), compareNodes);
+    size_t out = 1;
+    for (size_t i = 1; i < n; i++)
+        if (nodes[i].key != nodes[out - 1].key) nodes[out++] = nodes[i];
+    return out;
+}
+
+/* appends every reply to pos that does not end the game; false when out of memory */
+static bool addReplies(const Position *pos, BookNode **nodes, size_t *count, size_t *cap) {
+    for (int c = 0; c < cols; c++) {
+        if (!canPlay(pos, c) || isWinningMove(pos, c)) continue;
+        if (*count == *cap) {
+            *cap = *cap ? *cap * 2 : 64;
+            BookNode *grown = realloc(*nodes, *cap * sizeof(BookNode));
+            if (!grown) return false;
+            *nodes = grown;
+        }
+        BookNode *n = &(*nodes)[(*count)++];
+        n->pos = *pos;
+        playMove(&n->pos, c);
+        n->key = bookKey(&n->pos, &n->mirrored);
+    }
+    return true;
+}
+
+/* false where bot.c moves before it looks at the book: *col is then the
+ * block it must play, or -1 after a win, which ends the game */
+static bool playsBookMove(const Position *pos, int *col) {
+    *col = -1;
+    for (int c = 0; c < cols; c++)
+        if (canPlay(pos, c) && isWinningMove(pos, c)) return false;
+    for (int c = 0; c < cols; c++) {
+        if (canPlay(pos, c) && isOpponentWinningMove(pos, c)) {
+            *col = c;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool exact = false;
+    int argn = 1, horizon = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--exact") == 0) exact = true;
+        else if (strcmp(argv[i], "--horizon") == 0 && i + 1 < argc) horizon = atoi(argv[++i]);
+        else argv[argn++] = argv[i];
+    }
+    argc = argn;
+    const char *path = (argc >= 2) ? argv[1] : BOOK_DEFAULT_PATH;
+    int plies = (argc >= 3) ? atoi(argv[2]) : 6;
+    int depth = (argc >= 4) ? atoi(argv[3]) : 14;
+    int budgetMs = (argc >= 5) ? atoi(argv[4]) : 5000;
+    if (plies < 0 || plies >= rows * cols || depth < 1 || depth > MAX_DEPTH || budgetMs <= 0 ||
+        horizon < 0 || horizon >= rows * cols || (horizon && !exact)) {
+        printf("Usage: %s [book_file] [plies] [depth] [max_ms_per_position] [--exact [--horizon N]]\n", argv[0]);
+        return 1;
+    }
+
+    engineInit();
+    TranspositionTable tt;
+    Solver solver;
+    if (!ttInit(&tt, TT_DEFAULT_BITS + 2)) { printf("Not enough memory for the transposition table.\n"); return 1; }
+    if (exact && !solverInit(&solver, SOLVER_DEFAULT_BITS + 1)) { printf("Not enough memory for the solver table.\n"); return 1; }
+
+    /* breadth first, one ply at a time, so each level can be deduplicated */
+    size_t levelCount = 1, total = 0, cap = 1;
+    BookNode *all = malloc(sizeof(BookNode));
+    if (!all) { printf("Out of memory.\n"); return 1; }
+    positionInit(&all[0].pos);
+    all[0].key = bookKey(&all[0].pos, &all[0].mirrored);
+
+    size_t levelStart = 0;
+    for (int ply = 0; ; ply++) {
+        total = levelStart + levelCount;
+        printf("ply %d: %zu positions\n", ply, levelCount);
+        if (ply == plies) break;
+
+        size_t next = 0;
+        for (size_t i = levelStart; i < levelStart + levelCount; i++) {
+            for (int c = 0; c < cols; c++) {
+                if (!canPlay(&all[i].pos, c) || isWinningMove(&all[i].pos, c)) continue;
+                if (total + next == cap) {
+                    cap *= 2;
+                    BookNode *grown = realloc(all, cap * sizeof(BookNode));
+                    if (!grown) { printf("Out of memory.\n"); return 1; }
+                    all = grown;
+                }
+                BookNode *n = &all[total + next++];
+                n->pos = all[i].pos;
+                playMove(&n->pos, c);
+                n->key = bookKey(&n->pos, &n->mirrored);
+            }
+        }
+        levelStart = total;
+        levelCount = uniqueNodes(all + levelStart, next);
+        if (levelCount == 0) break;
+    }
+
+    BookEntry *entries = malloc(total * sizeof(BookEntry));
+    if (!entries) { printf("Out of memory.\n"); return 1; }
+    for (size_t n = 0; n < total; n++) {
+        size_t i = exact ? total - 1 - n : n;
+        Position pos = all[i].pos;
+        int col, score, scoreDepth;
+        if (exact) {
+            col = solverBestMove(&solver, &pos, &score);
+            scoreDepth = rows * cols - pos.moves;
+        } else {
+            SearchContext ctx;
+            searchInit(&ctx, &tt);
+            SearchResult r = iterativeDeepening(&ctx, &pos, depth, budgetMs);
+            col = r.bestCol;
+            score = r.score;
+            scoreDepth = r.depth;
+        }
+        if (all[i].mirrored) col = cols - 1 - col;
+        entries[i] = (BookEntry){ .key = all[i].key, .score = score, .bestCol = (uint8_t)col,
+                                  .depth = (uint8_t)scoreDepth, .flags = exact ? BOOK_EXACT : 0 };
+        if ((n + 1) % 100 == 0 || n + 1 == total) {
+            printf("\r%s %zu / %zu", exact ? "solved" : "searched", n + 1, total);
+            fflush(stdout);
+        }
+    }
+    printf("\n");
+    qsort(entries, total, sizeof(BookEntry), compareEntries);
+
+    /* Past `plies`, only what Perfect meets, as either side: on its turn
+     * the one move it plays, on the opponent's every reply. Each level has
+     * Perfect to move and grows from the level two plies before it, so the
+     * moves up to `plies` come from the book just built and the deeper
+     * ones are solved on the way. */
+    if (horizon > plies) {
+        size_t bookCount = total, cap = total;
+        BookNode *levels[2] = { NULL, NULL };
+        size_t counts[2] = { 0, 0 }, firstCap = 0;
+        Position start;
+        positionInit(&start);
+        levels[0] = malloc(sizeof(BookNode));
+        if (!levels[0] || !addReplies(&start, &levels[1], &counts[1], &firstCap)) { printf("Out of memory.\n"); return 1; }
+        levels[0][0] = (BookNode){ .pos = start };
+        levels[0][0].key = bookKey(&start, &levels[0][0].mirrored);
+        counts[0] = 1;
+        counts[1] = uniqueNodes(levels[1], counts[1]);
+
+        for (int ply = 0; ply <= horizon; ply++) {
+            BookNode *level = levels[ply & 1], *next = NULL;
+            size_t count = counts[ply & 1], nextCount = 0, nextCap = 0;
+            if (ply > plies) printf("ply %d: %zu positions with Perfect to move\n", ply, count);
+            for (size_t i = 0; i < count; i++) {
+                Position pos = level[i].pos;
+                int col, score;
+                if (playsBookMove(&pos, &col)) {
+                    if (ply <= plies) {
+                        Book book = { .entries = entries, .count = bookCount };
+                        if (!bookProbeExact(&book, &pos, &col, &score)) continue;
+                    } else {
+                        col = solverBestMove(&solver, &pos, &score);
+                        if (total == cap) {
+                            cap *= 2;
+                            BookEntry *grown = realloc(entries, cap * sizeof(BookEntry));
+                            if (!grown) { printf("Out of memory.\n"); return 1; }
+                            entries = grown;
+                        }
+                        entries[total++] = (BookEntry){ .key = level[i].key, .score = score,
+                                                        .bestCol = (uint8_t)(level[i].mirrored ? cols - 1 - col : col),
+                                                        .depth = (uint8_t)(rows * cols - pos.moves), .flags = BOOK_EXACT };
+                    }
+                }
+                if (ply > plies && ((i + 1) % 100 == 0 || i + 1 == count)) {
+                    printf("\rsolved %zu / %zu", i + 1, count);
+                    fflush(stdout);
+                }
+                if (col < 0 || ply + 2 > horizon) continue;
+                playMove(&pos, col);
+                if (!addReplies(&pos, &next, &nextCount, &nextCap)) { printf("Out of memory.\n"); return 1; }
+            }
+            if (ply > plies) printf("\n");
+            free(level);
+            levels[ply & 1] = next;
+            counts[ply & 1] = uniqueNodes(next, nextCount);
+        }
+        free(levels[0]);
+        free(levels[1]);
+        qsort(entries, total, sizeof(BookEntry), compareEntries);
+    }
+
+    FILE *f = fopen(path, "wb");
+    if (!f) { perror("fopen"); return 1; }
+    BookHeader h = { .magic = BOOK_MAGIC, .byteOrder = BOOK_BYTE_ORDER, .version = BOOK_VERSION,
+                     .boardRows = rows, .boardCols = cols, .maxPly = (uint32_t)plies, .count = total };
+    if (fwrite(&h, sizeof(h), 1, f) != 1 || fwrite(entries, sizeof(BookEntry), total, f) != total) {
+        perror("fwrite");
+        fclose(f);
+        return 1;
+    }
+    fclose(f);
+    printf("Wrote %zu positions to %s\n", total, path);
+
+    free(entries);
+    free(all);
+    ttFree(&tt);
+    if (exact) solverFree(&solver);
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bot.h"
+
+bool botInitSearch(Bot *bot, int difficulty, const Book *book, unsigned seed, BotSearchFn search, void *searchArg) {
+    *bot = (Bot){
+        .difficulty = difficulty, .budgetMs = DEFAULT_MOVE_BUDGET_MS, .maxDepth = MAX_DEPTH,
+        .searchMode = SEARCH_PVS, .book = book, .seed = seed, .search = search, .searchArg = searchArg,
+    };
+    engineInit();
+    if (difficulty >= BOT_HARD && !search && !ttInit(&bot->table, TT_DEFAULT_BITS)) return false;
+    if (difficulty == BOT_PERFECT && !solverInit(&bot->solver, SOLVER_DEFAULT_BITS)) {
+        ttFree(&bot->table);
+        return false;
+    }
+    return true;
+}
+
+bool botInit(Bot *bot, int difficulty, const Book *book, unsigned seed) {
+    return botInitSearch(bot, difficulty, book, seed, NULL, NULL);
+}
+
+void botFree(Bot *bot) {
+    if (bot->table.slots) ttFree(&bot->table);
+    if (bot->difficulty == BOT_PERFECT) solverFree(&bot->solver);
+}
+
+void botNewGame(Bot *bot) {
+    if (bot->table.slots) ttClear(&bot->table);
+}
+
+static int randomColumn(Bot *bot, char board[rows][cols]) {
+    int col;
+    do {
+        col = rand_r(&bot->seed) % cols;
+    } while (board[0][col] != '.');
+    return col;
+}
+
+static int choose(BotChoice *why, int col, int reason) {
+    why->col = col;
+    why->reason = reason;
+    return col;
+}
+
+int botChoose(Bot *bot, char board[rows][cols], char botSymbol, BotChoice *why) {
+    return botChoosePondered(bot, board, botSymbol, NULL, 0, why);
+}
+
+int botChoosePondered(Bot *bot, char board[rows][cols], char botSymbol, const SearchResult *pondered,
+                      long long ponderedNodes, BotChoice *why) {
+    *why = (BotChoice){ .col = -1 };
+    int difficulty = bot->difficulty;
+
+    if (difficulty == BOT_EASY) return choose(why, randomColumn(bot, board), CHOICE_EASY);
+
+    Position pos;
+    positionFromBoard(&pos, board, botSymbol);
+
+    for (int j = 0; j < cols; j++)
+        if (canPlay(&pos, j) && isWinningMove(&pos, j)) return choose(why, j, CHOICE_WIN);
+
+    for (int j = 0; j < cols; j++)
+        if (canPlay(&pos, j) && isOpponentWinningMove(&pos, j)) return choose(why, j, CHOICE_BLOCK);
+
+    if (difficulty == BOT_MEDIUM) {
+        if (board[0][cols / 2] == '.') return choose(why, cols / 2, CHOICE_CENTER);
+        for (int k = 0; k < cols; k++) {
+            int c = centerOrder[k];
+            if (board[0][c] == '.') return choose(why, c, CHOICE_STRATEGIC);
+        }
+        return choose(why, randomColumn(bot, board), CHOICE_RANDOM);
+    }
+
+    int budgetMs = bot->budgetMs;
+    int bookCol, bookScore;
+    if (difficulty == BOT_PERFECT) {
+        int score, solvedCol;
+        /* a solved book entry is as good as solving; a searched one is
+         * only a Hard move, for when the solver runs out of time */
+        if (!bot->book || !bookProbeExact(bot->book, &pos, &solvedCol, &score)) {
+            atomic_bool stop = false;
+            bot->solver.stop = &stop;
+            /* half the budget to prove a result, the rest for Hard if that fails */
+            bot->solver.deadline = deadlineAfterMs(budgetMs / 2);
+            bot->solver.nodes = 0;
+            solvedCol = solverBestMove(&bot->solver, &pos, &score);
+            bot->solver.stop = NULL;
+        }
+        if (solvedCol >= 0) {
+            why->score = score;
+            why->plies = solverPliesToEnd(&pos, score);
+            return choose(why, solvedCol, CHOICE_PERFECT);
+        }
+        why->solverTimedOut = true;
+        budgetMs -= budgetMs / 2;
+    }
+
+    if (bot->book && bookProbe(bot->book, &pos, &bookCol, &bookScore)) {
+        why->score = bookScore;
+        return choose(why, bookCol, CHOICE_BOOK);
+    }
+
+    SearchResult result;
+    if (pondered) {
+        result = *pondered;
+        why->nodes = ponderedNodes;
+        why->pondered = true;
+    } else if (bot->search) {
+        result = bot->search(bot, &pos, budgetMs, why);
+    } else {
+        SearchContext ctx;
+        searchInit(&ctx, &bot->table);
+        ctx.mode = bot->searchMode;
+        result = iterativeDeepening(&ctx, &pos, bot->maxDepth, budgetMs);
+        why->nodes = ctx.nodes;
+#ifdef SEARCH_STATS
+        why->stats = ctx.stats;
+#endif
+    }
+    int bestCol = result.bestCol;
+    why->score = result.score;
+    why->depth = result.depth;
+
+    if (bestCol < 0 || board[0][bestCol] != '.') {
+        for (int k = 0; k < cols && (bestCol < 0 || board[0][bestCol] != '.'); k++) bestCol = centerOrder[k];
+        if (board[0][bestCol] != '.') return choose(why, randomColumn(bot, board), CHOICE_FALLBACK);
+    }
+    return choose(why, bestCol, CHOICE_HARD);
+}
+
+void botPrintChoice(const BotChoice *why) {
+    int col = why->col + 1;
+    if (why->solverTimedOut) printf("Solver ran out of time, searching instead.\n");
+    switch (why->reason) {
+    case CHOICE_EASY: printf("Bot chooses column %d (Easy)\n", col); break;
+    case CHOICE_WIN: printf("Bot chooses column %d (Winning Move)\n", col); break;
+    case CHOICE_BLOCK: printf("Bot chooses column %d (Blocking Move)\n", col); break;
+    case CHOICE_CENTER: printf("Bot chooses column %d (Center Preference)\n", col); break;
+    case CHOICE_STRATEGIC: printf("Bot chooses column %d (Strategic Fallback)\n", col); break;
+    case CHOICE_RANDOM: printf("Bot chooses column %d (Random Fallback)\n", col); break;
+    case CHOICE_BOOK: printf("Bot chooses column %d (Opening Book, score %d)\n", col, why->score); break;
+    case CHOICE_PERFECT:
+        if (why->score > 0) printf("Bot chooses column %d (Perfect, wins in %d plies)\n", col, why->plies);
+        else if (why->score < 0) printf("Bot chooses column %d (Perfect, loses in %d plies)\n", col, why->plies);
+        else printf("Bot chooses column %d (Perfect, draw)\n", col);
+        break;
+    case CHOICE_HARD:
+        printf("Bot chooses column %d (Hard%s, depth %d, score %d, %lld nodes", col,
+               why->pondered ? ", pondered" : "", why->depth, why->score, why->nodes);
+        if (why->threads > 0) printf(", %d threads", why->threads);
+        printf(")\n");
+#ifdef SEARCH_STATS
+        searchStatsPrint(&why->stats, why->nodes);
+#endif
+        break;
+    default: printf("Bot chooses column %d (Fallback)\n", col); break;
+    }
+}
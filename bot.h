@@ -0,0 +1,83 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include "engine.h"
+#include "book.h"
+#include "solver.h"
+
+/* the difficulty menu of connect4 */
+enum { BOT_EASY = 1, BOT_MEDIUM, BOT_HARD, BOT_PERFECT };
+
+/* what decided the move */
+enum {
+    CHOICE_EASY,
+    CHOICE_WIN,
+    CHOICE_BLOCK,
+    CHOICE_CENTER,
+    CHOICE_STRATEGIC,
+    CHOICE_RANDOM,
+    CHOICE_BOOK,
+    CHOICE_PERFECT,
+    CHOICE_HARD,
+    CHOICE_FALLBACK
+};
+
+typedef struct {
+    int col;
+    int reason;                 /* CHOICE_... */
+    int score;                  /* book, solver or search score */
+    int depth;                  /* Hard: last finished iteration */
+    long long nodes;            /* Hard: nodes searched */
+    int threads;                /* Hard: threads that searched, 0 for the calling one only */
+    int plies;                  /* Perfect: plies until the game ends */
+    bool solverTimedOut;        /* Perfect ran out of time and Hard moved instead */
+    bool pondered;              /* Hard: the search ran on the opponent's time */
+#ifdef SEARCH_STATS
+    SearchStats stats;          /* Hard */
+#endif
+} BotChoice;
+
+typedef struct Bot Bot;
+
+/* Hard's search of pos, for a bot that brings its own; fills in the
+ * nodes, threads and stats of why */
+typedef SearchResult (*BotSearchFn)(Bot *bot, Position *pos, int budgetMs, BotChoice *why);
+
+/* One bot with everything it keeps between moves. Bots share nothing but
+ * the book, so each thread can run its own. */
+struct Bot {
+    int difficulty;             /* BOT_EASY .. BOT_PERFECT */
+    int budgetMs;               /* per move; Perfect gives half to the solver */
+    int maxDepth;               /* Hard's deepest iteration */
+    int searchMode;             /* SEARCH_PVS or SEARCH_MINIMAX */
+    TranspositionTable table;   /* Hard and Perfect */
+    Solver solver;              /* Perfect */
+    const Book *book;           /* optional, read only */
+    unsigned seed;              /* random moves, rand_r */
+    BotSearchFn search;         /* NULL: iterativeDeepening on table */
+    void *searchArg;            /* for search */
+};
+
+/* false if the tables do not fit in memory; with search set, Hard needs
+ * no table of its own */
+bool botInit(Bot *bot, int difficulty, const Book *book, unsigned seed);
+bool botInitSearch(Bot *bot, int difficulty, const Book *book, unsigned seed, BotSearchFn search, void *searchArg);
+void botFree(Bot *bot);
+
+/* forgets what earlier games left in the tables */
+void botNewGame(Bot *bot);
+
+/* The bot's column for board, where it plays botSymbol and is to move,
+ * and in *why what decided it. Prints nothing. */
+int botChoose(Bot *bot, char board[rows][cols], char botSymbol, BotChoice *why);
+
+/* as botChoose, but where Hard would search it takes pondered, a search
+ * of the same position already run on the opponent's time (ponder.h),
+ * with ponderedNodes behind it; NULL searches as botChoose does */
+int botChoosePondered(Bot *bot, char board[rows][cols], char botSymbol, const SearchResult *pondered,
+                      long long ponderedNodes, BotChoice *why);
+
+/* the "Bot chooses column ..." lines for a choice */
+void botPrintChoice(const BotChoice *why);
+
+#endif
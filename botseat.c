@@ -0,0 +1,130 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "botseat.h"
+
+static void answer(BotSeat *seat, Bot *bot, BotRequest *r, int waiting) {
+    long long now = monotonicNs();
+    long long left = (r->deadline - now) / 1000000;
+    long long budget = seat->budgetMs;
+    /* more requests than workers: each gets its share of the time */
+    if (waiting > seat->workerCount) budget = budget * seat->workerCount / waiting;
+    if (budget > left) budget = left;
+    r->late = left <= 0;
+    /* depth 1 ignores the clock, so even 1 ms gives a sound move */
+    bot->budgetMs = budget > 0 ? (int)budget : 1;
+    BotChoice why;
+    r->col = botChoose(bot, r->board, r->symbol, &why);
+}
+
+static void workerMain(void *arg) {
+    SeatWorker *w = arg;
+    BotSeat *seat = w->seat;
+    BotRequest *batch[SEAT_MAX_BATCH];
+    pthread_mutex_lock(&seat->lock);
+    while (true) {
+        while (!seat->head && !seat->quit) pthread_cond_wait(&seat->work, &seat->lock);
+        if (!seat->head) break;
+
+        /* a fair share of the queue, so one worker does not sit on it all */
+        int waiting = seat->queued;
+        int take = (waiting + seat->workerCount - 1) / seat->workerCount;
+        if (take > SEAT_MAX_BATCH) take = SEAT_MAX_BATCH;
+        long long now = monotonicNs();
+        int count = 0;
+        while (count < take && seat->head) {
+            BotRequest *r = seat->head;
+            seat->head = r->next;
+            seat->queued--;
+            seat->waitNs += now - r->queuedAt;
+            batch[count++] = r;
+        }
+        if (!seat->head) seat->tail = NULL;
+        pthread_mutex_unlock(&seat->lock);
+
+        for (int i = 0; i < count; i++) answer(seat, &w->bot, batch[i], waiting);
+
+        pthread_mutex_lock(&seat->lock);
+        for (int i = 0; i < count; i++) {
+            batch[i]->next = seat->done;
+            seat->done = batch[i];
+            seat->answered++;
+            seat->late += batch[i]->late;
+        }
+        uint64_t one = 1;
+        if (write(seat->notify, &one, sizeof(one)) < 0) { /* the counter is full: already readable */ }
+    }
+    pthread_mutex_unlock(&seat->lock);
+}
+
+bool seatInit(BotSeat *seat, int workers, int difficulty, int budgetMs, const Book *book) {
+    if (workers < 1) workers = 1;
+    if (workers > POOL_QUEUE_SIZE) workers = POOL_QUEUE_SIZE;
+    *seat = (BotSeat){ .budgetMs = budgetMs };
+    engineInit();
+    seat->workers = calloc(workers, sizeof(SeatWorker));
+    if (!seat->workers) return false;
+    for (; seat->workerCount < workers; seat->workerCount++) {
+        SeatWorker *w = &seat->workers[seat->workerCount];
+        w->seat = seat;
+        if (!botInit(&w->bot, difficulty, book, (unsigned)seat->workerCount + 1)) break;
+    }
+    seat->notify = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    pthread_mutex_init(&seat->lock, NULL);
+    pthread_cond_init(&seat->work, NULL);
+    if (seat->workerCount < workers || seat->notify < 0 || !poolInit(&seat->pool, workers, -1)) {
+        for (int i = 0; i < seat->workerCount; i++) botFree(&seat->workers[i].bot);
+        free(seat->workers);
+        if (seat->notify >= 0) close(seat->notify);
+        pthread_mutex_destroy(&seat->lock);
+        pthread_cond_destroy(&seat->work);
+        return false;
+    }
+    for (int i = 0; i < workers; i++) poolSubmit(&seat->pool, workerMain, &seat->workers[i]);
+    return true;
+}
+
+void seatFree(BotSeat *seat) {
+    pthread_mutex_lock(&seat->lock);
+    seat->quit = true;
+    pthread_cond_broadcast(&seat->work);
+    pthread_mutex_unlock(&seat->lock);
+    poolFree(&seat->pool);
+    for (int i = 0; i < seat->workerCount; i++) botFree(&seat->workers[i].bot);
+    free(seat->workers);
+    close(seat->notify);
+    pthread_mutex_destroy(&seat->lock);
+    pthread_cond_destroy(&seat->work);
+}
+
+void seatSubmit(BotSeat *seat, BotRequest *r) {
+    r->next = NULL;
+    r->queuedAt = monotonicNs();
+    pthread_mutex_lock(&seat->lock);
+    if (seat->tail) seat->tail->next = r;
+    else seat->head = r;
+    seat->tail = r;
+    seat->queued++;
+    pthread_cond_signal(&seat->work);
+    pthread_mutex_unlock(&seat->lock);
+}
+
+BotRequest *seatCollect(BotSeat *seat) {
+    uint64_t count;
+    if (read(seat->notify, &count, sizeof(count)) < 0) { /* nothing new since the last call */ }
+    pthread_mutex_lock(&seat->lock);
+    BotRequest *newest = seat->done;
+    seat->done = NULL;
+    pthread_mutex_unlock(&seat->lock);
+
+    BotRequest *oldest = NULL;
+    while (newest) {
+        BotRequest *next = newest->next;
+        newest->next = oldest;
+        oldest = newest;
+        newest = next;
+    }
+    return oldest;
+}
@@ -0,0 +1,64 @@
+#ifndef BOTSEAT_H
+#define BOTSEAT_H
+
+#include <pthread.h>
+
+#include "bot.h"
+#include "threadpool.h"
+
+#define SEAT_MAX_BATCH 8            /* requests a worker takes at once */
+
+typedef struct BotRequest BotRequest;
+
+/* One move wanted from the seat. The caller owns it and must leave it
+ * alone from seatSubmit until seatCollect hands it back. */
+struct BotRequest {
+    char board[rows][cols];
+    char symbol;                /* the bot's pieces on board */
+    long long deadline;         /* monotonic ns by which the answer is due */
+    void *owner;                /* the caller's, never touched */
+    int col;                    /* the answer */
+    bool late;                  /* the deadline had passed before a worker got to it */
+    long long queuedAt;
+    BotRequest *next;
+};
+
+typedef struct BotSeat BotSeat;
+
+typedef struct {
+    BotSeat *seat;
+    Bot bot;                    /* with a table of its own */
+} SeatWorker;
+
+/* A pool of engine workers serving bot moves for any number of games.
+ * Requests wait in one FIFO queue; a worker takes its fair share of them
+ * at once, up to SEAT_MAX_BATCH, and gives each a budget of its own: the
+ * configured time, cut to what is left before the deadline and, while
+ * more requests wait than there are workers, to its share of the CPU.
+ * Answers collect on a list, and notify, an eventfd, becomes readable
+ * whenever it is not empty, for the caller's event loop. */
+struct BotSeat {
+    SeatWorker *workers;
+    int workerCount;
+    int budgetMs;
+    ThreadPool pool;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    BotRequest *head, *tail;    /* waiting */
+    int queued;
+    BotRequest *done;           /* answered, newest first */
+    int notify;
+    bool quit;
+    long long answered, late;
+    long long waitNs;           /* summed time from submit to a worker taking it */
+};
+
+bool seatInit(BotSeat *seat, int workers, int difficulty, int budgetMs, const Book *book);
+void seatFree(BotSeat *seat);
+
+void seatSubmit(BotSeat *seat, BotRequest *r);
+
+/* every answered request, linked by next, oldest first; NULL if none */
+BotRequest *seatCollect(BotSeat *seat);
+
+#endif
@@ -10,8 +10,11 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 
-#define rows 6
-#define cols 7
+#include "engine.h"
+#include "book.h"
+#include "bot.h"
+#include "ponder.h"
+#include "protocol.h"
 
 void initialize(char board[rows][cols]) { for (int i=0;i<rows;i++) for (int j=0;j<cols;j++) board[i][j]='.'; }
 
@@ -31,18 +34,13 @@ bool update(char board[rows][cols], int col, char player) {
 }
 
 bool checkWin(char board[rows][cols], char player) {
-    for (int r=0;r<rows;r++) for (int c=0;c<=cols-4;c++)
-        if (board[r][c]==player && board[r][c+1]==player && board[r][c+2]==player && board[r][c+3]==player) return true;
-
-    for (int c=0;c<cols;c++) for (int r=0;r<=rows-4;r++)
-        if (board[r][c]==player && board[r+1][c]==player && board[r+2][c]==player && board[r+3][c]==player) return true;
-
-    for (int r=3;r<rows;r++) for (int c=0;c<=cols-4;c++)
-        if (board[r][c]==player && board[r-1][c+1]==player && board[r-2][c+2]==player && board[r-3][c+3]==player) return true;
-
-    for (int r=0;r<=rows-4;r++) for (int c=0;c<=cols-4;c++)
-        if (board[r][c]==player && board[r+1][c+1]==player && board[r+2][c+2]==player && board[r+3][c+3]==player) return true;
-
+    /* right, down, up-right and down-right from every cell */
+    static const int dirs[4][2] = { {0,1}, {1,0}, {-1,1}, {1,1} };
+    for (int d=0;d<4;d++) for (int i=0;i<rows;i++) for (int j=0;j<cols;j++) {
+        int k=0;
+        while (k<CONNECT) { int r=i+k*dirs[d][0], c=j+k*dirs[d][1]; if (r<0 || r>=rows || c>=cols || board[r][c]!=player) break; k++; }
+        if (k==CONNECT) return true;
+    }
     return false;
 }
 
@@ -86,93 +84,11 @@ int send_all(int sock, const void *buf, size_t len) {
 void send_int(int sock, int x) { int32_t net = htonl(x); send_all(sock, &net, sizeof(net)); }
 int recv_int(int sock, int *out) { int32_t net; if (recv_all(sock, &net, sizeof(net))<0) return -1; *out = ntohl(net); return 0; }
 
-/* ---------- Bot implementation (minimax + heuristics) ---------- */
-void copyBoard(char dst[rows][cols], char src[rows][cols]) { for (int i=0;i<rows;i++) for (int j=0;j<cols;j++) dst[i][j]=src[i][j]; }
-void getValidLocations(char board[rows][cols], int valid[], int *count) { *count=0; for (int j=0;j<cols;j++) if (board[0][j]=='.') valid[(*count)++]=j; }
-bool isTerminalNode(char board[rows][cols], char bot, char player) { return checkWin(board, bot) || checkWin(board, player) || boardFull(board); }
-
-int evaluateWindow(char window[4], char bot, char player) {
-    int score=0, botCount=0, playerCount=0, emptyCount=0;
-    for (int i=0;i<4;i++){ if (window[i]==bot) botCount++; else if (window[i]==player) playerCount++; else emptyCount++; }
-    if (botCount==4) score += 10000;
-    else if (botCount==3 && emptyCount==1) score += 100;
-    else if (botCount==2 && emptyCount==2) score += 10;
-    if (playerCount==3 && emptyCount==1) score -= 900;
-    else if (playerCount==2 && emptyCount==2) score -= 20;
-    return score;
-}
-
-int scorePosition(char board[rows][cols], char bot, char player) {
-    int score=0;
-    int centerCol = cols/2;
-    int centerCount=0;
-    for (int r=0;r<rows;r++) if (board[r][centerCol]==bot) centerCount++;
-    score += centerCount * 6;
-    for (int r=0;r<rows;r++) for (int c=0;c<=cols-4;c++){ char w[4]; for (int k=0;k<4;k++) w[k]=board[r][c+k]; score += evaluateWindow(w, bot, player); }
-    for (int c=0;c<cols;c++) for (int r=0;r<=rows-4;r++){ char w[4]; for (int k=0;k<4;k++) w[k]=board[r+k][c]; score += evaluateWindow(w, bot, player); }
-    for (int r=3;r<rows;r++) for (int c=0;c<=cols-4;c++){ char w[4]; for (int k=0;k<4;k++) w[k]=board[r-k][c+k]; score += evaluateWindow(w, bot, player); }
-    for (int r=0;r<=rows-4;r++) for (int c=0;c<=cols-4;c++){ char w[4]; for (int k=0;k<4;k++) w[k]=board[r+k][c+k]; score += evaluateWindow(w, bot, player); }
-    return score;
-}
-
-int minimax(char board[rows][cols], int depth, int alpha, int beta, bool maximizing, char bot, char player, int *bestCol) {
-    int valid[cols], cnt;
-    getValidLocations(board, valid, &cnt);
-    bool terminal = isTerminalNode(board, bot, player);
-    if (depth==0 || terminal) {
-        if (terminal) {
-            if (checkWin(board, bot)) return 100000000;
-            else if (checkWin(board, player)) return -100000000;
-            else return 0;
-        } else return scorePosition(board, bot, player);
-    }
-    if (maximizing) {
-        int value = INT_MIN; int column = valid[0];
-        for (int i=0;i<cnt;i++){
-            int c = valid[i]; char tmp[rows][cols]; copyBoard(tmp, board);
-            if (!update(tmp, c, bot)) continue;
-            int sc = minimax(tmp, depth-1, alpha, beta, false, bot, player, NULL);
-            if (sc > value) { value = sc; column = c; }
-            if (value > alpha) alpha = value;
-            if (alpha >= beta) break;
-        }
-        if (bestCol) *bestCol = column;
-        return value;
-    } else {
-        int value = INT_MAX; int column = valid[0];
-        for (int i=0;i<cnt;i++){
-            int c = valid[i]; char tmp[rows][cols]; copyBoard(tmp, board);
-            if (!update(tmp, c, player)) continue;
-            int sc = minimax(tmp, depth-1, alpha, beta, true, bot, player, NULL);
-            if (sc < value) { value = sc; column = c; }
-            if (value < beta) beta = value;
-            if (alpha >= beta) break;
-        }
-        if (bestCol) *bestCol = column;
-        return value;
-    }
-}
-
-int botMove(char board[rows][cols], char bot, char player, int difficulty) {
-    int col;
-    if (difficulty == 1) { do { col = rand()%cols; } while (board[0][col] != '.'); return col; }
-    for (int j=0;j<cols;j++){ char t[rows][cols]; copyBoard(t, board); if (update(t,j,bot) && checkWin(t,bot)) return j; }
-    for (int j=0;j<cols;j++){ char t[rows][cols]; copyBoard(t, board); if (update(t,j,player) && checkWin(t,player)) return j; }
-    if (difficulty == 2) {
-        if (board[0][cols/2]=='.') return cols/2;
-        int offs[] = {0,1,-1,2,-2,3,-3};
-        for (int k=0;k<7;k++){ int c=cols/2+offs[k]; if (c>=0 && c<cols && board[0][c]=='.') return c; }
-        do{ col = rand()%cols; } while (board[0][col] != '.'); return col;
-    }
-    int depth = 6;
-    int best = -1;
-    int sc = minimax(board, depth, INT_MIN+1, INT_MAX-1, true, bot, player, &best);
-    if (best < 0 || board[0][best] != '.') {
-        if (board[0][cols/2]=='.') best = cols/2;
-        else { int offs[] = {0,1,-1,2,-2,3,-3}; for (int k=0;k<7;k++){ int c=cols/2+offs[k]; if (c>=0 && c<cols && board[0][c]=='.'){ best=c; break; } } if (best<0){ do{ best=rand()%cols; } while (board[0][best] != '.'); } }
-    }
-    return best;
-}
+/* ---------- Bot (Hard, see bot.h) ---------- */
+static Bot bot;
+static Book openingBook;
+static int moveBudgetMs = DEFAULT_MOVE_BUDGET_MS;
+static Ponder ponder;
 
 /* ---------- Client socket ---------- */
 int start_client(const char *ip, int port) {
@@ -185,14 +101,130 @@ int start_client(const char *ip, int port) {
     printf("Connected.\n"); return s;
 }
 
+/* ---------- Playing a move ---------- */
+/* the human's or the bot's column for board, where it is B's turn */
+static int chooseMove(char board[rows][cols], int mode, char B) {
+    int chosenCol = -1;
+    if (mode == 1) {
+        printf("Your turn (Player %c). Enter column (1-%d): ", B, cols);
+        fflush(stdout);
+        chosenCol = getColumnLocal(cols);
+    } else {
+        /* the book and the immediate wins and blocks still come first */
+        Position pos; positionFromBoard(&pos, board, B);
+        SearchResult pondered;
+        long long nodes = 0;
+        bool hit = ponderStop(&ponder, &pos, &pondered, &nodes) >= 0;
+        BotChoice why;
+        chosenCol = botChoosePondered(&bot, board, B, hit ? &pondered : NULL, nodes, &why);
+        botPrintChoice(&why);
+    }
+    return chosenCol;
+}
+
+/* think about the answers while the other side thinks about its move */
+static void afterMove(char board[rows][cols], int mode, char A, char B) {
+    if (mode == 2 && !checkWin(board, B) && !boardFull(board)) {
+        Position pos; positionFromBoard(&pos, board, A);
+        ponderStart(&ponder, &bot.table, &pos, moveBudgetMs);
+    }
+}
+
+static void printResult(int status, char A, char B) {
+    if (status == 1) printf("Server (Player %c) WINS.\n", A);
+    else if (status == 2) printf("Client (Player %c) WINS.\n", B);
+    else printf("Draw.\n");
+}
+
+/* ---------- Compact protocol ---------- */
+/* next whole message into m; its size, or -1 once the server is gone */
+static int recvMessage(int sock, unsigned char m[MSG_MAX + 1]) {
+    if (recv_all(sock, m, 1) < 0 || m[0] == 0 || recv_all(sock, m + 1, m[0]) < 0) return -1;
+    return 1 + m[0];
+}
+
+/* keeps its own board from the first BOARD and the MOVEs after it */
+static void playCompact(int sock) {
+    unsigned char m[MSG_MAX + 1];
+    int n = msgHello(m);
+    if (send_all(sock, m, n) < 0) { printf("Server closed connection.\n"); return; }
+
+    char board[rows][cols];
+    initialize(board);
+    char A='X', B='O';
+    int mode = 0, ply = 0;
+    bool started = false;
+
+    while (1) {
+        int size = recvMessage(sock, m);
+        if (size < 0) { printf("Server closed connection.\n"); break; }
+        int status, yourTurn;
+        if (m[1] == MSG_BOARD && size == MSG_BOARD_SIZE) {
+            if (m[2] != PROTOCOL_VERSION) { printf("Server speaks protocol version %d. Exiting.\n", m[2]); break; }
+            if (!started) {
+                mode = m[3];
+                printf("Mode from server: %s\n", (mode==1)?"PVP (you are human Player 2)":"PVB (you are bot Player 2)");
+                started = true;
+            }
+            ply = m[8]; status = m[9]; yourTurn = m[10];
+            memcpy(board, m + 11, sizeof(board));
+        } else if (m[1] == MSG_MOVE && size == MSG_MOVE_SIZE && started) {
+            status = m[8]; yourTurn = m[9];
+            /* a move of ours echoed back needs nothing but its status; one
+             * we cannot place means we are out of step: ask for the board */
+            if (m[6] >= ply && (m[6] > ply || !update(board, m[7], (ply % 2 == 0) ? A : B))) {
+                n = msgResync(m);
+                if (send_all(sock, m, n) < 0) { printf("Server closed connection.\n"); break; }
+                continue;
+            }
+            if (m[6] == ply) ply++;
+        } else {
+            printf("Unexpected message from the server. Exiting.\n");
+            break;
+        }
+
+        printBoardLocal(board);
+        if (status != 0) { printResult(status, A, B); break; }
+
+        if (yourTurn == 1) {
+            int chosenCol = chooseMove(board, mode, B);
+            n = msgPlay(m, ply, chosenCol);
+            if (send_all(sock, m, n) < 0) { printf("Server closed connection.\n"); break; }
+            update(board, chosenCol, B);
+            ply++;
+            afterMove(board, mode, A, B);
+        }
+    }
+}
+
 /* ---------- Main ---------- */
 int main(int argc, char **argv) {
     srand((unsigned int)time(NULL));
-    if (argc < 2) { printf("Usage: %s <server_ip> [port]\n", argv[0]); return 0; }
+    engineInit();
+    bookOpen(&openingBook, BOOK_DEFAULT_PATH);
+    if (!botInit(&bot, BOT_HARD, &openingBook, (unsigned)time(NULL))) { printf("Not enough memory for the bot's transposition table.\n"); return 1; }
+    /* --compact anywhere: the server's compact port, see protocol.h */
+    bool compact = false;
+    int argn = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--compact") == 0) compact = true;
+        else argv[argn++] = argv[i];
+    }
+    argc = argn;
+    if (argc < 2) { printf("Usage: %s <server_ip> [port] [bot_ms_per_move] [--compact]\n", argv[0]); return 0; }
     const char *server_ip = argv[1];
     int port = 9000; if (argc >= 3) port = atoi(argv[2]);
+    if (argc >= 4) moveBudgetMs = atoi(argv[3]);
+    if (moveBudgetMs <= 0) moveBudgetMs = DEFAULT_MOVE_BUDGET_MS;
+    bot.budgetMs = moveBudgetMs;
 
     int sock = start_client(server_ip, port);
+    if (compact) {
+        playCompact(sock);
+        ponderStop(&ponder, NULL, NULL, NULL);
+        close(sock);
+        return 0;
+    }
 
     int mode;
     if (recv_int(sock, &mode) < 0) { printf("Failed to receive mode. Exiting.\n"); close(sock); return 0; }
@@ -211,30 +243,17 @@ int main(int argc, char **argv) {
         // show board (helpful for human)
         printBoardLocal(board);
 
-        if (status != 0) {
-            if (status == 1) printf("Server (Player %c) WINS.\n", A);
-            else if (status == 2) printf("Client (Player %c) WINS.\n", B);
-            else printf("Draw.\n");
-            break;
-        }
+        if (status != 0) { printResult(status, A, B); break; }
 
         if (yourTurn == 1) {
-            int chosenCol = -1;
-            if (mode == 1) {
-                printf("Your turn (Player %c). Enter column (1-%d): ", B, cols);
-                fflush(stdout);
-                chosenCol = getColumnLocal(cols);
-            } else {
-                int difficulty = 3;
-                chosenCol = botMove(board, B, A, difficulty);
-                printf("Bot chooses column %d\n", chosenCol + 1);
-            }
-
+            int chosenCol = chooseMove(board, mode, B);
             send_int(sock, chosenCol);
             update(board, chosenCol, B);
+            afterMove(board, mode, A, B);
         }
     }
 
+    ponderStop(&ponder, NULL, NULL, NULL);
     close(sock);
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
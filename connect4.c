@@ -5,8 +5,7 @@
 #include <limits.h>
 #include <string.h>
 
-#define rows 6
-#define cols 7
+#include "bot.h"
 
 void initialize(char board[rows][cols]) {
     for (int i = 0; i < rows; i++)
@@ -38,46 +37,21 @@ bool update(char board[rows][cols], int col, char player) {
 }
 
 bool checkWin(char board[rows][cols], char player) {
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j <= cols - 4; j++) {
-            if (board[i][j] == player &&
-                board[i][j + 1] == player &&
-                board[i][j + 2] == player &&
-                board[i][j + 3] == player)
-                return true;
-        }
-    }
-
-    for (int j = 0; j < cols; j++) {
-        for (int i = 0; i <= rows - 4; i++) {
-            if (board[i][j] == player &&
-                board[i + 1][j] == player &&
-                board[i + 2][j] == player &&
-                board[i + 3][j] == player)
-                return true;
-        }
-    }
-
-    for (int i = 3; i < rows; i++) {
-        for (int j = 0; j <= cols - 4; j++) {
-            if (board[i][j] == player &&
-                board[i - 1][j + 1] == player &&
-                board[i - 2][j + 2] == player &&
-                board[i - 3][j + 3] == player)
-                return true;
-        }
-    }
-
-    for (int i = 0; i <= rows - 4; i++) {
-        for (int j = 0; j <= cols - 4; j++) {
-            if (board[i][j] == player &&
-                board[i + 1][j + 1] == player &&
-                board[i + 2][j + 2] == player &&
-                board[i + 3][j + 3] == player)
-                return true;
+    /* right, down, up-right and down-right from every cell */
+    static const int dirs[4][2] = { {0, 1}, {1, 0}, {-1, 1}, {1, 1} };
+    for (int d = 0; d < 4; d++) {
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                int k = 0;
+                while (k < CONNECT) {
+                    int r = i + k * dirs[d][0], c = j + k * dirs[d][1];
+                    if (r < 0 || r >= rows || c >= cols || board[r][c] != player) break;
+                    k++;
+                }
+                if (k == CONNECT) return true;
+            }
         }
     }
-
     return false;
 }
 
@@ -105,242 +79,24 @@ int getColumn(int maxCols) {
     }
 }
 
-void copyBoard(char dest[rows][cols], char src[rows][cols]) {
-    for (int i = 0; i < rows; i++)
-        for (int j = 0; j < cols; j++)
-            dest[i][j] = src[i][j];
-}
-
-void getValidLocations(char board[rows][cols], int valid[], int *validCount) {
-    *validCount = 0;
-    for (int j = 0; j < cols; j++) {
-        if (board[0][j] == '.') {
-            valid[(*validCount)++] = j;
-        }
-    }
-}
-
-bool isTerminalNode(char board[rows][cols], char bot, char player) {
-    return checkWin(board, bot) || checkWin(board, player) || boardFull(board);
-}
-
-int evaluateWindow(char window[4], char bot, char player) {
-    int score = 0;
-    int botCount = 0, playerCount = 0, emptyCount = 0;
-    for (int i = 0; i < 4; i++) {
-        if (window[i] == bot) botCount++;
-        else if (window[i] == player) playerCount++;
-        else emptyCount++;
-    }
-
-    if (botCount == 4) score += 10000;
-    else if (botCount == 3 && emptyCount == 1) score += 100;
-    else if (botCount == 2 && emptyCount == 2) score += 10;
-
-    if (playerCount == 3 && emptyCount == 1) score -= 900;
-    else if (playerCount == 2 && emptyCount == 2) score -= 20;
-
-    return score;
-}
-
-int scorePosition(char board[rows][cols], char bot, char player) {
-    int score = 0;
-
-    int centerCol = cols / 2;
-    int centerCount = 0;
-    for (int r = 0; r < rows; r++)
-        if (board[r][centerCol] == bot) centerCount++;
-    score += centerCount * 6;
-
-    for (int r = 0; r < rows; r++) {
-        for (int c = 0; c <= cols - 4; c++) {
-            char window[4];
-            for (int k = 0; k < 4; k++) window[k] = board[r][c + k];
-            score += evaluateWindow(window, bot, player);
-        }
-    }
-
-    for (int c = 0; c < cols; c++) {
-        for (int r = 0; r <= rows - 4; r++) {
-            char window[4];
-            for (int k = 0; k < 4; k++) window[k] = board[r + k][c];
-            score += evaluateWindow(window, bot, player);
-        }
-    }
-
-    for (int r = 3; r < rows; r++) {
-        for (int c = 0; c <= cols - 4; c++) {
-            char window[4];
-            for (int k = 0; k < 4; k++) window[k] = board[r - k][c + k];
-            score += evaluateWindow(window, bot, player);
-        }
-    }
-
-    for (int r = 0; r <= rows - 4; r++) {
-        for (int c = 0; c <= cols - 4; c++) {
-            char window[4];
-            for (int k = 0; k < 4; k++) window[k] = board[r + k][c + k];
-            score += evaluateWindow(window, bot, player);
-        }
-    }
-
-    return score;
-}
-
-int minimax(char board[rows][cols], int depth, int alpha, int beta, bool maximizingPlayer, char bot, char player, int *bestCol) {
-    int valid[cols];
-    int validCount;
-    getValidLocations(board, valid, &validCount);
+static Book openingBook;
+static Bot bot;
+static int moveBudgetMs = DEFAULT_MOVE_BUDGET_MS;
+static int searchMode = SEARCH_PVS;
 
-    bool isTerminal = isTerminalNode(board, bot, player);
-    if (depth == 0 || isTerminal) {
-        if (isTerminal) {
-            if (checkWin(board, bot)) return 100000000;   // very large positive
-            else if (checkWin(board, player)) return -100000000; // very large negative
-            else return 0; // draw
-        } else {
-            return scorePosition(board, bot, player);
-        }
-    }
-
-    if (maximizingPlayer) {
-        int value = INT_MIN;
-        int column = valid[0];
-        for (int i = 0; i < validCount; i++) {
-            int col = valid[i];
-            char temp[rows][cols];
-            copyBoard(temp, board);
-            if (!update(temp, col, bot)) continue;
-            int newScore = minimax(temp, depth - 1, alpha, beta, false, bot, player, NULL);
-            if (newScore > value) { value = newScore; column = col; }
-            if (value > alpha) alpha = value;
-            if (alpha >= beta) break;
-        }
-        if (bestCol) *bestCol = column;
-        return value;
-    } else {
-        int value = INT_MAX;
-        int column = valid[0];
-        for (int i = 0; i < validCount; i++) {
-            int col = valid[i];
-            char temp[rows][cols];
-            copyBoard(temp, board);
-            if (!update(temp, col, player)) continue;
-            int newScore = minimax(temp, depth - 1, alpha, beta, true, bot, player, NULL);
-            if (newScore < value) { value = newScore; column = col; }
-            if (value < beta) beta = value;
-            if (alpha >= beta) break;
-        }
-        if (bestCol) *bestCol = column;
-        return value;
-    }
-}
-
-int botMove(char board[rows][cols], char bot, char player, int difficulty) {
-    int col;
-
-    if (difficulty == 1) {
-        do {
-            col = rand() % cols;
-        } while (board[0][col] != '.');
-        printf("Bot chooses column %d (Easy)\n", col + 1);
-        return col;
-    }
-
-    for (int j = 0; j < cols; j++) {
-        char temp[rows][cols];
-        copyBoard(temp, board);
-        if (update(temp, j, bot) && checkWin(temp, bot)) {
-            printf("Bot chooses column %d (Winning Move)\n", j + 1);
-            return j;
-        }
-    }
-
-    for (int j = 0; j < cols; j++) {
-        char temp[rows][cols];
-        copyBoard(temp, board);
-        if (update(temp, j, player) && checkWin(temp, player)) {
-            printf("Bot chooses column %d (Blocking Move)\n", j + 1);
-            return j;
-        }
-    }
-
-    if (difficulty == 2) {
-        if (board[0][cols / 2] == '.') {
-            printf("Bot chooses column %d (Center Preference)\n", cols / 2 + 1);
-            return cols / 2;
-        }
-
-        int offsets[] = {0, 1, -1, 2, -2, 3, -3};
-        for (int k = 0; k < 7; k++) {
-            int c = cols / 2 + offsets[k];
-            if (c >= 0 && c < cols && board[0][c] == '.') {
-                printf("Bot chooses column %d (Strategic Fallback)\n", c + 1);
-                return c;
-            }
-        }
-
-        do {
-            col = rand() % cols;
-        } while (board[0][col] != '.');
-        printf("Bot chooses column %d (Random Fallback)\n", col + 1);
-        return col;
-    }
-
-    if (difficulty == 3) {
-        for (int j = 0; j < cols; j++) {
-            char temp[rows][cols];
-            copyBoard(temp, board);
-            if (update(temp, j, bot) && checkWin(temp, bot)) {
-                printf("Bot chooses column %d (Winning Move)\n", j + 1);
-                return j;
-            }
-        }
-        for (int j = 0; j < cols; j++) {
-            char temp[rows][cols];
-            copyBoard(temp, board);
-            if (update(temp, j, player) && checkWin(temp, player)) {
-                printf("Bot chooses column %d (Blocking Move)\n", j + 1);
-                return j;
-            }
-        }
-
-        int depth = 6;
-
-        int bestCol = -1;
-        int score = minimax(board, depth, INT_MIN + 1, INT_MAX - 1, true, bot, player, &bestCol);
-
-        if (bestCol < 0 || board[0][bestCol] != '.') {
-            if (board[0][cols / 2] == '.') {
-                bestCol = cols / 2;
-            } else {
-                int offsets[] = {0, 1, -1, 2, -2, 3, -3};
-                for (int k = 0; k < 7; k++) {
-                    int c = cols / 2 + offsets[k];
-                    if (c >= 0 && c < cols && board[0][c] == '.') {
-                        bestCol = c;
-                        break;
-                    }
-                }
-                if (bestCol < 0) {
-                    do { bestCol = rand() % cols; } while (board[0][bestCol] != '.');
-                }
-            }
-        }
-
-        printf("Bot chooses column %d (Hard, score %d)\n", bestCol + 1, score);
-        return bestCol;
-    }
-
-    do {
-        col = rand() % cols;
-    } while (board[0][col] != '.');
-    printf("Bot chooses column %d (Fallback)\n", col + 1);
+int botMove(char board[rows][cols], char symbol) {
+    BotChoice why;
+    int col = botChoose(&bot, board, symbol, &why);
+    botPrintChoice(&why);
     return col;
 }
 
-int main() {
-    srand((unsigned int)time(NULL));
+int main(int argc, char **argv) {
+    engineInit();
+    if (argc >= 2) moveBudgetMs = atoi(argv[1]);
+    if (moveBudgetMs <= 0) moveBudgetMs = DEFAULT_MOVE_BUDGET_MS;
+    if (argc >= 3 && strcmp(argv[2], "minimax") == 0) searchMode = SEARCH_MINIMAX;
+    bookOpen(&openingBook, BOOK_DEFAULT_PATH);
     char A, B;
     int mode, difficulty = 0;
 
@@ -357,12 +113,26 @@ int main() {
     } else {
         B = 'O';
         printf("Bot symbol is '%c'\n", B);
-        printf("Choose difficulty:\n1. Easy\n2. Medium\n3. Hard\n> ");
+        printf("Choose difficulty:\n1. Easy\n2. Medium\n3. Hard\n4. Perfect\n> ");
         scanf("%d", &difficulty);
         printf("You selected ");
         if (difficulty == 1) printf("Easy\n");
         else if (difficulty == 2) printf("Medium\n");
+        else if (difficulty == 4) printf("Perfect\n");
         else printf("Hard\n");
+        if (difficulty < BOT_EASY || difficulty > BOT_PERFECT) difficulty = BOT_HARD;
+
+        bool ready = botInit(&bot, difficulty, &openingBook, (unsigned)time(NULL));
+        if (!ready && difficulty == BOT_PERFECT) {
+            printf("Not enough memory for the solver, playing Hard instead.\n");
+            ready = botInit(&bot, BOT_HARD, &openingBook, (unsigned)time(NULL));
+        }
+        if (!ready) {
+            printf("Not enough memory for the bot's transposition table.\n");
+            return 1;
+        }
+        bot.budgetMs = moveBudgetMs;
+        bot.searchMode = searchMode;
     }
 
     char player = A;
@@ -374,7 +144,7 @@ int main() {
         int col;
 
         if (mode == 2 && player == B) {
-            col = botMove(board, B, A, difficulty);
+            col = botMove(board, B);
         } else {
             printf("Player %c, enter column (1-%d): ", player, cols);
             fflush(stdout);
@@ -405,4 +175,4 @@ int main() {
     }
 
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "variant.h"
+
+/* Connect Four on any of the compiled board variants, against a friend or
+ * the Hard bot. Usage: connectn [board=7x6] [ms per bot move] */
+
+static const Variant *game;
+static int moves[256];          /* more than any variant has cells */
+static int moveCount = 0;
+
+static void print(void) {
+    int rows = game->boardRows, cols = game->boardCols;
+    char board[rows][cols];
+    memset(board, '.', sizeof(board));
+    int height[cols];
+    for (int j = 0; j < cols; j++) height[j] = 0;
+    for (int i = 0; i < moveCount; i++) {
+        int col = moves[i];
+        board[rows - 1 - height[col]++][col] = (i & 1) ? 'O' : 'X';
+    }
+
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++)
+            printf("%c ", board[i][j]);
+        printf("\n");
+    }
+    for (int j = 0; j < cols; j++)
+        printf("%d ", (j + 1) % 10);
+    printf("\n\n");
+}
+
+static int getColumn(int maxCols) {
+    int col;
+    while (1) {
+        if (scanf("%d", &col) == 1) {
+            if (col >= 1 && col <= maxCols)
+                return col - 1;
+            else
+                printf("Invalid column. Enter a number (1-%d): ", maxCols);
+        } else {
+            if (feof(stdin)) exit(0);
+            while (getchar() != '\n');
+            printf("Invalid input. Enter a number (1-%d): ", maxCols);
+        }
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char **argv) {
+    game = variantFind(argc >= 2 ? argv[1] : "7x6");
+    if (!game) {
+        printf("Unknown board '%s'. Boards:", argv[1]);
+        for (int i = 0; i < variantCount; i++) printf(" %s", variants[i]->name);
+        printf("\n");
+        return 1;
+    }
+    int budgetMs = argc >= 3 ? atoi(argv[2]) : 1000;
+    if (budgetMs <= 0) budgetMs = 1000;
+    if (!game->init()) {
+        printf("Not enough memory for the bot's transposition table.\n");
+        return 1;
+    }
+
+    printf("Welcome to Connect Four, %s: %d columns, %d rows, %d in a row!\n",
+           game->name, game->boardCols, game->boardRows, game->connect);
+    printf("Choose mode:\n1. Player vs Player\n2. Player vs Bot\n> ");
+    int mode;
+    if (scanf("%d", &mode) != 1) return 0;
+
+    while (true) {
+        print();
+        int col;
+        char player = (moveCount & 1) ? 'O' : 'X';
+
+        if (mode == 2 && player == 'O') {
+            VariantResult r = game->search(moves, moveCount, budgetMs);
+            col = r.bestCol;
+            printf("Bot chooses column %d (Hard, depth %d, score %d, %lld nodes)\n",
+                   col + 1, r.depth, r.score, r.nodes);
+        } else {
+            printf("Player %c, enter column (1-%d): ", player, game->boardCols);
+            fflush(stdout);
+            col = getColumn(game->boardCols);
+        }
+
+        moves[moveCount++] = col;
+        int status = game->status(moves, moveCount);
+        if (status == VARIANT_ILLEGAL) {
+            moveCount--;
+            printf("Invalid move. Try again.\n");
+            continue;
+        }
+        if (status == VARIANT_WON) {
+            print();
+            if (mode == 2 && player == 'O')
+                printf("Bot wins!\n");
+            else
+                printf("Player %c wins!\n", player);
+            break;
+        }
+        if (status == VARIANT_DRAWN) {
+            print();
+            printf("It's a draw!\n");
+            break;
+        }
+    }
+
+    game->release();
+    return 0;
+}
@@ -0,0 +1,588 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "engine.h"
+#include "threats.h"
+
+int centerOrder[cols];
+static bool engineReady = false;
+
+uint64_t zobristKeys[2][BB_H * cols];
+static uint64_t zobristBotToMove;
+
+/* splitmix64, fixed seed so hashes are the same from run to run */
+static uint64_t nextRandom(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void engineInit(void) {
+    if (engineReady) return;
+
+    evalTablesInit();
+
+    /* same center-out order as the Medium bot: 0, +1, -1, +2, -2, ...; an
+     * even board has no middle column, so it goes left first to reach
+     * column 0 last */
+    for (int k = 0; k < cols; k++) {
+        int offset = (k + 1) / 2;
+        centerOrder[k] = cols / 2 + (((k & 1) != (cols % 2 == 0)) ? offset : -offset);
+    }
+
+    uint64_t seed = 0x241C4;
+    for (int k = 0; k < 2; k++)
+        for (int i = 0; i < BB_H * cols; i++)
+            zobristKeys[k][i] = nextRandom(&seed);
+    zobristBotToMove = nextRandom(&seed);
+
+    engineReady = true;
+}
+
+/* ---------- Transposition table ---------- */
+
+bool ttInit(TranspositionTable *tt, int bits) {
+    size_t size = (size_t)1 << bits;
+    tt->slots = calloc(size, sizeof(TTSlot));
+    tt->mask = tt->slots ? size - 1 : 0;
+    return tt->slots != NULL;
+}
+
+void ttFree(TranspositionTable *tt) {
+    free(tt->slots);
+    tt->slots = NULL;
+    tt->mask = 0;
+}
+
+void ttClear(TranspositionTable *tt) {
+    for (size_t i = 0; i <= tt->mask; i++) {
+        atomic_store_explicit(&tt->slots[i].check, 0, memory_order_relaxed);
+        atomic_store_explicit(&tt->slots[i].data, 0, memory_order_relaxed);
+    }
+}
+
+static uint64_t ttPack(int score, int depth, int bound, int bestCol) {
+    return (uint64_t)(uint32_t)score | (uint64_t)(uint8_t)depth << 32 |
+           (uint64_t)(uint8_t)bound << 40 | (uint64_t)(uint8_t)bestCol << 48;
+}
+
+/* copies the entry for key into *e; false if the slot holds something else */
+bool ttProbe(TranspositionTable *tt, uint64_t key, TTEntry *e) {
+    TTSlot *slot = &tt->slots[key & tt->mask];
+    uint64_t data = atomic_load_explicit(&slot->data, memory_order_relaxed);
+    uint64_t check = atomic_load_explicit(&slot->check, memory_order_relaxed);
+    e->bound = (uint8_t)(data >> 40);
+    if ((check ^ data) != key || e->bound == BOUND_NONE) return false;
+    e->key = key;
+    e->score = (int32_t)(uint32_t)data;
+    e->depth = (int8_t)(data >> 32);
+    e->bestCol = (int8_t)(data >> 48);
+    return true;
+}
+
+/* depth-preferred replacement: keep a deeper result for a different position */
+static void ttStore(TranspositionTable *tt, uint64_t key, int depth, int bound, int score, int bestCol) {
+    TTSlot *slot = &tt->slots[key & tt->mask];
+    uint64_t old = atomic_load_explicit(&slot->data, memory_order_relaxed);
+    uint64_t oldKey = atomic_load_explicit(&slot->check, memory_order_relaxed) ^ old;
+    if ((uint8_t)(old >> 40) != BOUND_NONE && oldKey != key && (int8_t)(old >> 32) > depth) return;
+    uint64_t data = ttPack(score, depth, bound, bestCol);
+    atomic_store_explicit(&slot->check, key ^ data, memory_order_relaxed);
+    atomic_store_explicit(&slot->data, data, memory_order_relaxed);
+}
+
+/* ---------- Time control ---------- */
+
+long long monotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+long long deadlineAfterMs(int budgetMs) {
+    return monotonicNs() + budgetMs * 1000000LL;
+}
+
+/* polled at every node; the clock is only read every 1024 nodes */
+bool searchStopped(SearchContext *ctx) {
+    if (ctx->aborted && ctx->aborted(ctx)) return true;
+    if (!ctx->stop) return false;
+    if (ctx->deadline && (ctx->nodes & 1023) == 0 && monotonicNs() >= ctx->deadline)
+        atomic_store_explicit(ctx->stop, true, memory_order_relaxed);
+    return atomic_load_explicit(ctx->stop, memory_order_relaxed);
+}
+
+/* ---------- Move ordering ---------- */
+
+#define HISTORY_LIMIT (1 << 20)
+
+void searchInit(SearchContext *ctx, TranspositionTable *tt) {
+    *ctx = (SearchContext){ .tt = tt, .mode = SEARCH_PVS };
+    for (int p = 0; p <= MAX_DEPTH; p++) ctx->killers[p][0] = ctx->killers[p][1] = -1;
+}
+
+static int cellIndex(const Position *pos, int col) {
+    return col * BB_H + pos->height[col];
+}
+
+/* fills order[] with the columns in candidates, best guess first; returns the count */
+static int orderMoves(SearchContext *ctx, const Position *pos, unsigned candidates, int ttCol, int order[cols]) {
+    int keys[cols];
+    int count = 0;
+    int ply = pos->moves;
+    int pvCol = (ctx->followPv && ply >= ctx->pvStart && ply < ctx->pvEnd) ? ctx->pv[ply] : -1;
+
+    for (int k = 0; k < cols; k++) {
+        int col = centerOrder[k];
+        if (!(candidates & (1u << col))) continue;
+        int key = ctx->history[ply & 1][cellIndex(pos, col)];
+        if (col == ctx->killers[ply][1]) key = 1 << 27;
+        if (col == ctx->killers[ply][0]) key = 1 << 28;
+        if (col == ttCol) key = 1 << 29;
+        if (col == pvCol) key = 1 << 30;
+
+        /* insertion sort, stable so ties keep the center-out order */
+        int i = count++;
+        while (i > 0 && keys[i - 1] < key) {
+            keys[i] = keys[i - 1];
+            order[i] = order[i - 1];
+            i--;
+        }
+        keys[i] = key;
+        order[i] = col;
+    }
+    return count;
+}
+
+static void recordCutoff(SearchContext *ctx, const Position *pos, int col, int depth) {
+    int ply = pos->moves;
+    if (ctx->killers[ply][0] != col) {
+        ctx->killers[ply][1] = ctx->killers[ply][0];
+        ctx->killers[ply][0] = col;
+    }
+    int *h = &ctx->history[ply & 1][cellIndex(pos, col)];
+    *h += depth * depth;
+    if (*h >= HISTORY_LIMIT) {
+        for (int k = 0; k < 2; k++)
+            for (int i = 0; i < BB_H * cols; i++) ctx->history[k][i] /= 2;
+    }
+}
+
+/* reads the best line of the last iteration back out of the table */
+static void collectPv(SearchContext *ctx, Position *pos, int depth, bool maximizingPlayer) {
+    Position line = *pos;
+    ctx->pvStart = ctx->pvEnd = pos->moves;
+    for (int d = 0; d < depth && ctx->tt && !positionFull(&line); d++) {
+        uint64_t key = line.hash ^ (maximizingPlayer ? zobristBotToMove : 0);
+        TTEntry e;
+        if (!ttProbe(ctx->tt, key, &e) || !canPlay(&line, e.bestCol)) break;
+        ctx->pv[ctx->pvEnd++] = e.bestCol;
+        if (hasLine(line.current | moveBit(&line, e.bestCol))) break;
+        playMove(&line, e.bestCol);
+        maximizingPlayer = !maximizingPlayer;
+    }
+}
+
+/* ---------- Search ---------- */
+
+/* a new root: every move below keeps eval in step */
+static void syncEval(SearchContext *ctx, const Position *pos) {
+    if (!ctx->evalReady || ctx->evalHash != pos->hash) {
+        evalInit(&ctx->eval, pos);
+        ctx->evalHash = pos->hash;
+        ctx->evalReady = true;
+    }
+}
+
+static void searchPlay(SearchContext *ctx, Position *pos, int col) {
+    evalPlay(&ctx->eval, pos->moves & 1, cellIndex(pos, col));
+    playMove(pos, col);
+    ctx->evalHash = pos->hash;
+}
+
+static void searchUndo(SearchContext *ctx, Position *pos, int col) {
+    undoMove(pos, col);
+    evalUndo(&ctx->eval, pos->moves & 1, cellIndex(pos, col));
+    ctx->evalHash = pos->hash;
+}
+
+/* Returns the column that wins on the spot, or -1 and the columns worth
+ * searching in *candidates: a forced block if the opponent threatens to
+ * win, and never a move right below an opponent threat (threats.h). If
+ * every move loses at once, *lost is set and *candidates holds one
+ * column, a block if there is one, to report. */
+static int scanThreats(const Position *pos, unsigned *candidates, bool *lost) {
+    bitboard possible = possibleMoves(pos);
+    bitboard wins = winningCells(pos->current, pos->mask) & possible;
+    if (wins) return bbLowest(wins) / BB_H;
+
+    bitboard next = nonLosingMoves(pos);
+    *lost = next == 0;
+    if (*lost) {
+        bitboard blocks = possible & opponentWinningCells(pos);
+        next = blocks ? blocks : possible;
+        next &= -next;
+    }
+    *candidates = cellColumns(next);
+    return -1;
+}
+
+/* the bot's leaf score: windows plus threats */
+static int leafScore(SearchContext *ctx, const Position *pos, int botColour) {
+    bitboard mover = pos->current, other = pos->current ^ pos->mask;
+    bool botToMove = (pos->moves & 1) == botColour;
+    return evalScore(&ctx->eval, botColour) +
+           threatScore(botToMove ? mover : other, botToMove ? other : mover, pos->mask, botColour);
+}
+
+int minimax(SearchContext *ctx, Position *pos, int depth, int alpha, int beta, bool maximizingPlayer, int *bestCol) {
+    ctx->nodes++;
+    if (searchStopped(ctx)) return 0;
+    if (hasLine(lastMover(pos))) return maximizingPlayer ? -WIN_SCORE : WIN_SCORE;
+    if (positionFull(pos)) return 0;
+
+    syncEval(ctx, pos);
+    int colour = pos->moves & 1;
+    if (depth == 0) {
+        STAT(ctx->stats.leaves++;)
+        return leafScore(ctx, pos, maximizingPlayer ? colour : !colour);
+    }
+
+    /* winning move first: nothing else needs searching */
+    unsigned candidates;
+    bool lost;
+    int winCol = scanThreats(pos, &candidates, &lost);
+    if (winCol >= 0) {
+        if (bestCol) *bestCol = winCol;
+        return maximizingPlayer ? WIN_SCORE : -WIN_SCORE;
+    }
+    if (lost) {
+        if (bestCol) *bestCol = __builtin_ctz(candidates);
+        return maximizingPlayer ? -WIN_SCORE : WIN_SCORE;
+    }
+
+    /* scores are from the bot's point of view, so the key records whose turn that is */
+    uint64_t key = pos->hash ^ (maximizingPlayer ? zobristBotToMove : 0);
+    int ttCol = -1;
+    if (ctx->tt) {
+        TTEntry entry, *e = &entry;
+        STAT(ctx->stats.ttProbes++;)
+        if (ttProbe(ctx->tt, key, e)) {
+            STAT(ctx->stats.ttHits++;)
+            ttCol = e->bestCol;
+            /* the root always searches so it can report a column */
+            if (!bestCol && e->depth >= depth) {
+                if (e->bound == BOUND_LOWER && e->score > alpha) alpha = e->score;
+                if (e->bound == BOUND_UPPER && e->score < beta) beta = e->score;
+                if (e->bound == BOUND_EXACT || alpha >= beta) {
+                    STAT(ctx->stats.ttCutoffs++;)
+                    return e->score;
+                }
+            }
+        }
+    }
+
+    int alphaOrig = alpha, betaOrig = beta;
+    int order[cols];
+    int count = orderMoves(ctx, pos, candidates, ttCol, order);
+    bool onPv = ctx->followPv && pos->moves >= ctx->pvStart && pos->moves < ctx->pvEnd;
+
+    int value = maximizingPlayer ? INT_MIN : INT_MAX;
+    int column = count > 0 ? order[0] : -1;
+    for (int i = 0; i < count; i++) {
+        int col = order[i];
+        ctx->followPv = onPv && col == ctx->pv[pos->moves];
+        searchPlay(ctx, pos, col);
+        int newScore = minimax(ctx, pos, depth - 1, alpha, beta, !maximizingPlayer, NULL);
+        searchUndo(ctx, pos, col);
+        if (searchStopped(ctx)) return value;
+        if (maximizingPlayer) {
+            if (newScore > value) { value = newScore; column = col; }
+            if (value > alpha) alpha = value;
+        } else {
+            if (newScore < value) { value = newScore; column = col; }
+            if (value < beta) beta = value;
+        }
+        if (alpha >= beta) {
+            STAT(ctx->stats.cutoffs++; if (i == 0) ctx->stats.firstCutoffs++;)
+            recordCutoff(ctx, pos, col, depth);
+            break;
+        }
+    }
+
+    if (ctx->tt) {
+        int bound = BOUND_EXACT;
+        if (value <= alphaOrig) bound = BOUND_UPPER;
+        else if (value >= betaOrig) bound = BOUND_LOWER;
+        ttStore(ctx->tt, key, depth, bound, value, column);
+    }
+
+    if (bestCol) *bestCol = column;
+    return value;
+}
+
+/* Depth 1 with batchLeaves: every child is a leaf, so their windows are
+ * scored in one scorePositions() call (only with a SIMD kernel: the scalar
+ * one gains nothing from a batch and would lose the early cutoffs) and they are walked in search order,
+ * adding each one's threat term, which gives the same value, column and
+ * cutoff as searching them one by one. No child wins on the spot,
+ * scanThreats has made sure of that. */
+static int searchFrontier(SearchContext *ctx, const Position *pos, const int *order, int count,
+                          int alpha, int beta, int *column) {
+    bitboard bot[cols], player[cols];
+    int scores[cols];
+    bool botToMove = (pos->moves & 1) == ctx->botColour;
+    bitboard mover = pos->current, other = pos->current ^ pos->mask;
+    for (int i = 0; i < count; i++) {
+        bitboard after = mover | moveBit(pos, order[i]);
+        bot[i] = botToMove ? after : other;
+        player[i] = botToMove ? other : after;
+    }
+    scorePositions(bot, player, count, scores);
+
+    bool full = pos->moves + 1 == rows * cols;
+    int value = -INT_MAX;
+    for (int i = 0; i < count; i++) {
+        ctx->nodes++;
+        if (searchStopped(ctx)) return value;
+        int score = 0;
+        if (!full) {
+            STAT(ctx->stats.leaves++;)
+            score = scores[i] + threatScore(bot[i], player[i], pos->mask | moveBit(pos, order[i]), ctx->botColour);
+            if (!botToMove) score = -score;
+        }
+        if (score > value) { value = score; *column = order[i]; }
+        if (value > alpha) alpha = value;
+        if (alpha >= beta) {
+            STAT(ctx->stats.cutoffs++; if (i == 0) ctx->stats.firstCutoffs++;)
+            recordCutoff(ctx, pos, order[i], 1);
+            break;
+        }
+    }
+    return value;
+}
+
+/* Fail-soft negamax: scores are from the side to move. The heuristic is
+ * not symmetric, so leaves are the bot's score, negated when the other
+ * side is to move, which keeps every value equal to minimax's up to sign.
+ * Table entries are stored from the bot's side as well, so both searches
+ * can share one table. */
+int negamax(SearchContext *ctx, Position *pos, int depth, int alpha, int beta, int *bestCol) {
+    ctx->nodes++;
+    if (searchStopped(ctx)) return 0;
+    if (hasLine(lastMover(pos))) return -WIN_SCORE;
+    if (positionFull(pos)) return 0;
+
+    syncEval(ctx, pos);
+    bool botToMove = (pos->moves & 1) == ctx->botColour;
+    if (depth == 0) {
+        STAT(ctx->stats.leaves++;)
+        int score = leafScore(ctx, pos, ctx->botColour);
+        return botToMove ? score : -score;
+    }
+
+    unsigned candidates;
+    bool lost;
+    int winCol = scanThreats(pos, &candidates, &lost);
+    if (winCol >= 0) {
+        if (bestCol) *bestCol = winCol;
+        return WIN_SCORE;
+    }
+    /* whatever is played, the opponent wins next move */
+    if (lost) {
+        if (bestCol) *bestCol = __builtin_ctz(candidates);
+        return -WIN_SCORE;
+    }
+
+    int sign = botToMove ? 1 : -1;
+    uint64_t key = pos->hash ^ (botToMove ? zobristBotToMove : 0);
+    int ttCol = -1;
+    if (ctx->tt) {
+        TTEntry entry, *e = &entry;
+        STAT(ctx->stats.ttProbes++;)
+        if (ttProbe(ctx->tt, key, e)) {
+            STAT(ctx->stats.ttHits++;)
+            ttCol = e->bestCol;
+            if (!bestCol && e->depth >= depth) {
+                int score = sign * e->score;
+                int bound = e->bound;
+                if (!botToMove && bound != BOUND_EXACT) bound = (bound == BOUND_LOWER) ? BOUND_UPPER : BOUND_LOWER;
+                if (bound == BOUND_LOWER && score > alpha) alpha = score;
+                if (bound == BOUND_UPPER && score < beta) beta = score;
+                if (bound == BOUND_EXACT || alpha >= beta) {
+                    STAT(ctx->stats.ttCutoffs++;)
+                    return score;
+                }
+            }
+        }
+    }
+
+    int alphaOrig = alpha;
+    int order[cols];
+    int count = orderMoves(ctx, pos, candidates, ttCol, order);
+    bool onPv = ctx->followPv && pos->moves >= ctx->pvStart && pos->moves < ctx->pvEnd;
+
+    int value = -INT_MAX;
+    int column = count > 0 ? order[0] : -1;
+    if (depth == 1 && ctx->batchLeaves && evalKernel() != EVAL_KERNEL_SCALAR) {
+        value = searchFrontier(ctx, pos, order, count, alpha, beta, &column);
+        if (searchStopped(ctx)) return value;
+        count = 0;      /* nothing left to search one by one */
+    }
+    for (int i = 0; i < count; i++) {
+        int col = order[i];
+        ctx->followPv = onPv && col == ctx->pv[pos->moves];
+        int score;
+        if (i == 0) {
+            searchPlay(ctx, pos, col);
+            score = -negamax(ctx, pos, depth - 1, -beta, -alpha, NULL);
+            searchUndo(ctx, pos, col);
+        } else {
+            score = searchSibling(ctx, pos, col, depth, alpha, beta);
+        }
+        if (searchStopped(ctx)) return value;
+        if (score > value) { value = score; column = col; }
+        if (value > alpha) alpha = value;
+        if (alpha >= beta) {
+            STAT(ctx->stats.cutoffs++; if (i == 0) ctx->stats.firstCutoffs++;)
+            recordCutoff(ctx, pos, col, depth);
+            break;
+        }
+        /* the first move is done, so idle threads may take the rest */
+        if (i == 0 && count > 1 && ctx->split &&
+            ctx->split(ctx, pos, depth, alpha, beta, order + 1, count - 1, &value, &column)) {
+            syncEval(ctx, pos);
+            STAT(if (value >= beta) ctx->stats.cutoffs++;)
+            if (searchStopped(ctx)) return value;
+            break;
+        }
+    }
+
+    if (ctx->tt) {
+        int bound = BOUND_EXACT;
+        if (value <= alphaOrig) bound = BOUND_UPPER;
+        else if (value >= beta) bound = BOUND_LOWER;
+        if (!botToMove && bound != BOUND_EXACT) bound = (bound == BOUND_LOWER) ? BOUND_UPPER : BOUND_LOWER;
+        ttStore(ctx->tt, key, depth, bound, sign * value, column);
+    }
+
+    if (bestCol) *bestCol = column;
+    return value;
+}
+
+/* Searches a later move of a node at the given depth: a null window proves
+ * it no better than alpha, and only a move that lands inside (alpha, beta)
+ * is searched again with the full window. */
+int searchSibling(SearchContext *ctx, Position *pos, int col, int depth, int alpha, int beta) {
+    syncEval(ctx, pos);
+    searchPlay(ctx, pos, col);
+    int score = -negamax(ctx, pos, depth - 1, -alpha - 1, -alpha, NULL);
+    if (score > alpha && score < beta && !searchStopped(ctx))
+        score = -negamax(ctx, pos, depth - 1, -beta, -alpha, NULL);
+    searchUndo(ctx, pos, col);
+    return score;
+}
+
+/* one root iteration of the PVS search; starts from a window around the
+ * score of two iterations back, since the heuristic swings between odd and
+ * even depths, and widens it whenever the result falls outside */
+static int aspirationSearch(SearchContext *ctx, Position *pos, int depth, int previous, int *bestCol) {
+    if (depth <= 2 || previous >= WIN_SCORE || previous <= -WIN_SCORE)
+        return negamax(ctx, pos, depth, INT_MIN + 1, INT_MAX - 1, bestCol);
+
+    int delta = ASPIRATION_WINDOW;
+    int alpha = previous - delta, beta = previous + delta;
+    while (true) {
+        int score = negamax(ctx, pos, depth, alpha, beta, bestCol);
+        if (searchStopped(ctx)) return score;
+        if (score > alpha && score < beta) return score;
+        delta *= 4;
+        if (delta > WIN_SCORE) {
+            alpha = INT_MIN + 1;
+            beta = INT_MAX - 1;
+        } else if (score <= alpha) {
+            alpha = score - delta;
+        } else {
+            beta = score + delta;
+        }
+        if (alpha < -WIN_SCORE) alpha = INT_MIN + 1;
+        if (beta > WIN_SCORE) beta = INT_MAX - 1;
+    }
+}
+
+/* Searches depth 1, 2, ... until maxDepth, the end of the game or the budget.
+ * The answer always comes from the last iteration that finished; depth 1
+ * runs without the clock so there is always a move unless *stop was set. */
+SearchResult iterativeDeepening(SearchContext *ctx, Position *pos, int maxDepth, int budgetMs) {
+    SearchResult result = { -1, 0, 0 };
+    atomic_bool localStop = false;
+    atomic_bool *savedStop = ctx->stop;
+    long long savedDeadline = ctx->deadline;
+    if (!ctx->stop) ctx->stop = &localStop;
+
+    int remaining = rows * cols - pos->moves;
+    if (maxDepth > remaining) maxDepth = remaining;
+    long long deadline = deadlineAfterMs(budgetMs);
+
+    int scores[MAX_DEPTH + 1];
+    ctx->pvStart = ctx->pvEnd = 0;
+    ctx->botColour = pos->moves & 1;
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        ctx->deadline = depth == 1 ? 0 : deadline;
+        ctx->followPv = true;
+        int col = -1;
+        int score;
+        STAT(long long depthStart = monotonicNs(), nodesStart = ctx->nodes;)
+        if (ctx->mode == SEARCH_PVS) score = aspirationSearch(ctx, pos, depth, depth > 2 ? scores[depth - 2] : 0, &col);
+        else score = minimax(ctx, pos, depth, INT_MIN + 1, INT_MAX - 1, true, &col);
+        if (searchStopped(ctx)) break;
+        result.bestCol = col;
+        result.score = score;
+        scores[depth] = score;
+        result.depth = depth;
+        STAT(ctx->stats.depth = depth;
+             ctx->stats.depthNodes[depth] = ctx->nodes - nodesStart;
+             ctx->stats.depthNs[depth] = monotonicNs() - depthStart;)
+        /* a forced result will not change with more depth */
+        if (score >= WIN_SCORE || score <= -WIN_SCORE) break;
+        if (monotonicNs() >= deadline) break;
+        collectPv(ctx, pos, depth, true);
+    }
+
+    ctx->stop = savedStop;
+    ctx->deadline = savedDeadline;
+    return result;
+}
+
+/* ---------- Statistics ---------- */
+
+#ifdef SEARCH_STATS
+/* adds the counters of s to sum; the iterations stay sum's own */
+void searchStatsAdd(SearchStats *sum, const SearchStats *s) {
+    sum->leaves += s->leaves;
+    sum->cutoffs += s->cutoffs;
+    sum->firstCutoffs += s->firstCutoffs;
+    sum->ttProbes += s->ttProbes;
+    sum->ttHits += s->ttHits;
+    sum->ttCutoffs += s->ttCutoffs;
+    sum->splitMoves += s->splitMoves;
+}
+
+static double percent(long long part, long long whole) {
+    return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+void searchStatsPrint(const SearchStats *s, long long nodes) {
+    printf("Stats: %lld nodes, %lld leaves, %lld cutoffs (%.1f%% on the first move), "
+           "table %lld/%lld hits (%.1f%%), %lld table cutoffs\n",
+           nodes, s->leaves, s->cutoffs, percent(s->firstCutoffs, s->cutoffs),
+           s->ttHits, s->ttProbes, percent(s->ttHits, s->ttProbes), s->ttCutoffs);
+    for (int d = 1; d <= s->depth; d++)
+        printf("  depth %2d: %11lld nodes %10.3f ms\n", d, s->depthNodes[d], s->depthNs[d] / 1e6);
+}
+#endif
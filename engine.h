@@ -0,0 +1,140 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "bitboard.h"
+#include "eval.h"
+
+#define WIN_SCORE 100000000
+#define MAX_DEPTH (rows * cols)
+#define DEFAULT_MOVE_BUDGET_MS 1000
+
+/* ---------- Transposition table ---------- */
+
+#define TT_DEFAULT_BITS 20
+
+enum { BOUND_NONE, BOUND_EXACT, BOUND_LOWER, BOUND_UPPER };
+
+typedef struct {
+    uint64_t key;
+    int score;
+    int8_t depth;
+    uint8_t bound;
+    int8_t bestCol;
+} TTEntry;
+
+/* Lockless slot, safe to share between threads: data packs the entry and
+ * check is key ^ data, so a slot torn by two writers fails the key test
+ * and reads as a miss instead of as another position's score. */
+typedef struct {
+    _Atomic uint64_t check;
+    _Atomic uint64_t data;
+} TTSlot;
+
+typedef struct {
+    TTSlot *slots;
+    size_t mask;        /* slot count - 1, the count is a power of two */
+} TranspositionTable;
+
+bool ttInit(TranspositionTable *tt, int bits);
+void ttFree(TranspositionTable *tt);
+void ttClear(TranspositionTable *tt);
+bool ttProbe(TranspositionTable *tt, uint64_t key, TTEntry *e);
+
+/* ---------- Search ---------- */
+
+enum {
+    SEARCH_MINIMAX,     /* two-branch minimax with a full window */
+    SEARCH_PVS          /* negamax with principal variation search and aspiration windows */
+};
+
+#define ASPIRATION_WINDOW 1000      /* about one open three */
+
+/* ---------- Statistics ----------
+ * Built with -DSEARCH_STATS, every search context also counts what its
+ * search did, for tuning; without it the counters and every STAT()
+ * update compile to nothing. */
+
+#ifdef SEARCH_STATS
+typedef struct {
+    long long leaves;               /* heuristic evaluations */
+    long long cutoffs;              /* nodes that reached beta */
+    long long firstCutoffs;         /* ... on their first move */
+    long long ttProbes;
+    long long ttHits;
+    long long ttCutoffs;            /* hits that settled the node without a search */
+    long long splitMoves;           /* moves taken from split points (parallel.c) */
+    int depth;                      /* deepest iteration recorded below */
+    long long depthNodes[MAX_DEPTH + 1];    /* per finished iteration */
+    long long depthNs[MAX_DEPTH + 1];
+} SearchStats;
+#define STAT(...) __VA_ARGS__
+#else
+#define STAT(...)
+#endif
+
+typedef struct SearchContext SearchContext;
+
+struct SearchContext {
+    TranspositionTable *tt;     /* optional, NULL searches without one */
+    long long nodes;
+    atomic_bool *stop;          /* optional; once set, the search unwinds and its result is void */
+    long long deadline;         /* monotonic ns at which to set *stop, 0 for none */
+    int mode;                   /* SEARCH_MINIMAX or SEARCH_PVS, used by iterativeDeepening */
+    int botColour;              /* colour whose score negamax reports, set by iterativeDeepening */
+
+    /* move ordering state, indexed by absolute ply (Position.moves) */
+    int killers[MAX_DEPTH + 1][2];  /* quiet moves that caused a cutoff at this ply, -1 if none */
+    int history[2][BB_H * cols];    /* cutoff credit per colour and cell */
+    int pv[MAX_DEPTH + 1];          /* best line of the previous iteration */
+    int pvStart, pvEnd;             /* pv[pvStart .. pvEnd - 1] is valid */
+    bool followPv;                  /* the current node lies on that line */
+
+    Evaluator eval;                 /* leaf scores, kept in step with the searched position */
+    uint64_t evalHash;              /* hash of the position eval describes */
+    bool evalReady;
+    bool batchLeaves;               /* negamax scores the children of depth-1 nodes in one batch, unless the eval kernel is scalar */
+#ifdef SEARCH_STATS
+    SearchStats stats;              /* cleared by searchInit only */
+#endif
+
+    /* Parallel search (parallel.c), all NULL when searching alone. Once the
+     * first move of a node is searched, split may hand the other moves to
+     * idle threads; it returns false to keep searching them here. aborted
+     * tells a thread its subtree is no longer needed. */
+    bool (*split)(SearchContext *ctx, Position *pos, int depth, int alpha, int beta,
+                  const int *moves, int count, int *value, int *column);
+    bool (*aborted)(SearchContext *ctx);
+    void *worker;
+};
+
+typedef struct {
+    int bestCol;                /* -1 if not even depth 1 completed */
+    int score;
+    int depth;                  /* last fully completed iteration */
+} SearchResult;
+
+/* columns from the middle outwards: 0, +1, -1, +2, -2, ... */
+extern int centerOrder[cols];
+
+void engineInit(void);
+void searchInit(SearchContext *ctx, TranspositionTable *tt);
+
+long long monotonicNs(void);
+long long deadlineAfterMs(int budgetMs);
+bool searchStopped(SearchContext *ctx);
+
+int minimax(SearchContext *ctx, Position *pos, int depth, int alpha, int beta, bool maximizingPlayer, int *bestCol);
+int negamax(SearchContext *ctx, Position *pos, int depth, int alpha, int beta, int *bestCol);
+int searchSibling(SearchContext *ctx, Position *pos, int col, int depth, int alpha, int beta);
+SearchResult iterativeDeepening(SearchContext *ctx, Position *pos, int maxDepth, int budgetMs);
+
+#ifdef SEARCH_STATS
+void searchStatsAdd(SearchStats *sum, const SearchStats *s);
+/* one summary line for nodes searched with s, then the iterations */
+void searchStatsPrint(const SearchStats *s, long long nodes);
+#endif
+
+#endif
@@ -0,0 +1,522 @@
+#include <stdbool.h>
+
+#include "eval.h"
+
+/* the SIMD kernels hold a board per 64-bit lane and count windows of four */
+#if defined(__GNUC__) && defined(__x86_64__) && CONNECT == 4 && BB_BITS <= 64
+#include <immintrin.h>
+#define EVAL_X86 1
+#endif
+
+#define MAX_CELL_WINDOWS (4 * CONNECT)
+
+bitboard windows[WINDOW_COUNT];
+int windowScore[CONNECT + 1][CONNECT + 1];
+
+static uint8_t cellWindows[BB_H * cols][MAX_CELL_WINDOWS];
+static uint8_t cellWindowCount[BB_H * cols];
+
+/* score change for a colour when it adds a stone to a window holding
+ * [own][other] stones, and when the other colour does */
+static int ownDelta[CONNECT][CONNECT];
+static int otherDelta[CONNECT][CONNECT];
+
+/* The four window directions as bit shifts, and the cells a window in that
+ * direction can start from (its lowest bit). Since a window holding both
+ * colours scores nothing, the heuristic is a weight per stone count, for
+ * windows holding only bot stones and for windows holding only player
+ * stones. */
+#define DIRECTIONS 4
+#ifdef EVAL_X86
+static uint64_t dirShift[3][DIRECTIONS];    /* 1, 2 and 3 steps */
+#endif
+static bitboard dirStart[DIRECTIONS];
+static int botWeight[CONNECT + 1];
+static int playerWeight[CONNECT + 1];
+
+static int scoreScalar(bitboard bot, bitboard player);
+static void scoreBatchScalar(const bitboard *bot, const bitboard *player, int count, int *scores);
+static int (*scoreKernel)(bitboard bot, bitboard player) = scoreScalar;
+static void (*batchKernel)(const bitboard *bot, const bitboard *player, int count, int *scores) = scoreBatchScalar;
+static int activeKernel = EVAL_KERNEL_SCALAR;
+
+/* same weights as the old evaluateWindow, indexed by [botCount][playerCount];
+ * on longer lines "three" and "two" mean one and two cells short */
+static int evaluateWindow(int botCount, int playerCount) {
+    int score = 0;
+    int emptyCount = CONNECT - botCount - playerCount;
+
+    if (botCount == CONNECT) score += 10000;
+    else if (botCount == CONNECT - 1 && emptyCount == 1) score += 100;
+    else if (botCount == CONNECT - 2 && emptyCount == 2) score += 10;
+
+    if (playerCount == CONNECT - 1 && emptyCount == 1) score -= 900;
+    else if (playerCount == CONNECT - 2 && emptyCount == 2) score -= 20;
+
+    return score;
+}
+
+static bitboard makeWindow(int r, int c, int dr, int dc) {
+    bitboard w = 0;
+    for (int k = 0; k < CONNECT; k++) w |= cellBit(r + k * dr, c + k * dc);
+    return w;
+}
+
+void evalTablesInit(void) {
+    int n = 0;
+    for (int r = 0; r < rows; r++)
+        for (int c = 0; c <= cols - CONNECT; c++) windows[n++] = makeWindow(r, c, 0, 1);
+    for (int c = 0; c < cols; c++)
+        for (int r = 0; r <= rows - CONNECT; r++) windows[n++] = makeWindow(r, c, 1, 0);
+    for (int r = 0; r <= rows - CONNECT; r++)
+        for (int c = 0; c <= cols - CONNECT; c++) windows[n++] = makeWindow(r, c, 1, 1);
+    for (int r = CONNECT - 1; r < rows; r++)
+        for (int c = 0; c <= cols - CONNECT; c++) windows[n++] = makeWindow(r, c, -1, 1);
+
+    for (int b = 0; b <= CONNECT; b++)
+        for (int p = 0; b + p <= CONNECT; p++)
+            windowScore[b][p] = evaluateWindow(b, p);
+
+    for (int a = 0; a < CONNECT; a++) {
+        for (int b = 0; a + b < CONNECT; b++) {
+            ownDelta[a][b] = windowScore[a + 1][b] - windowScore[a][b];
+            otherDelta[a][b] = windowScore[b][a + 1] - windowScore[b][a];
+        }
+    }
+
+    static const int steps[DIRECTIONS] = { 1, BB_H, BB_H + 1, BB_H - 1 };
+    for (int d = 0; d < DIRECTIONS; d++) {
+#ifdef EVAL_X86
+        for (int k = 0; k < 3; k++) dirShift[k][d] = (uint64_t)(k + 1) * steps[d];
+#endif
+        dirStart[d] = 0;
+    }
+    for (int w = 0; w < WINDOW_COUNT; w++) {
+        int first = bbLowest(windows[w]);
+        int step = bbLowest(windows[w] & (windows[w] - 1)) - first;
+        for (int d = 0; d < DIRECTIONS; d++)
+            if (steps[d] == step) dirStart[d] |= (bitboard)1 << first;
+    }
+    for (int k = 0; k <= CONNECT; k++) {
+        botWeight[k] = windowScore[k][0];
+        playerWeight[k] = windowScore[0][k];
+    }
+    evalSelectKernel(evalBestKernel());
+
+    for (int i = 0; i < BB_H * cols; i++) cellWindowCount[i] = 0;
+    for (int w = 0; w < WINDOW_COUNT; w++) {
+        for (int i = 0; i < BB_H * cols; i++) {
+            if (windows[w] & ((bitboard)1 << i))
+                cellWindows[i][cellWindowCount[i]++] = (uint8_t)w;
+        }
+    }
+}
+
+/* ---------- Full-board kernels ---------- */
+
+/* one window at a time, the reference the kernels below must match */
+int scorePositionWindows(bitboard bot, bitboard player) {
+    int score = bbPopcount(bot & columnMask(cols / 2)) * CENTER_WEIGHT;
+    for (int i = 0; i < WINDOW_COUNT; i++)
+        score += windowScore[bbPopcount(bot & windows[i])][bbPopcount(player & windows[i])];
+    return score;
+}
+
+#if CONNECT == 4
+
+/* Bit-sliced adder: for every start cell, x0..x3 are the stones on the
+ * four cells of its window; adds up the weight of each window by its
+ * stone count, counting only the starts in only. */
+static inline int weighWindows(bitboard x0, bitboard x1, bitboard x2, bitboard x3, bitboard only, const int *weight) {
+    bitboard s = x0 ^ x1, c = x0 & x1;
+    bitboard t = x2 ^ x3, d = x2 & x3;
+    bitboard low = s ^ t, carry = s & t;
+    bitboard mid = c ^ d ^ carry;
+    bitboard four = (c & d) | (carry & (c ^ d));
+    return weight[1] * bbPopcount(low & ~mid & only) +
+           weight[2] * bbPopcount(mid & ~low & only) +
+           weight[3] * bbPopcount(mid & low & only) +
+           weight[4] * bbPopcount(four & only);
+}
+
+static inline int scoreDirection(bitboard bot, bitboard player, int step, bitboard start) {
+    bitboard b1 = bot >> step, b2 = bot >> (2 * step), b3 = bot >> (3 * step);
+    bitboard p1 = player >> step, p2 = player >> (2 * step), p3 = player >> (3 * step);
+    bitboard botOnly = start & ~(player | p1 | p2 | p3);
+    bitboard playerOnly = start & ~(bot | b1 | b2 | b3);
+    return weighWindows(bot, b1, b2, b3, botOnly, botWeight) +
+           weighWindows(player, p1, p2, p3, playerOnly, playerWeight);
+}
+
+#else
+
+/* Longer lines count stones into a three-bit counter per start cell, one
+ * cell of the window at a time; the loops have constant bounds, so each
+ * geometry gets them unrolled. */
+static inline int weighRuns(bitboard stones, int step, bitboard only, const int *weight) {
+    bitboard c0 = 0, c1 = 0, c2 = 0;
+    for (int k = 0; k < CONNECT; k++) {
+        bitboard x = stones >> (k * step);
+        bitboard carry = c0 & x;
+        c0 ^= x;
+        c2 |= c1 & carry;
+        c1 ^= carry;
+    }
+    int score = 0;
+    for (int n = 1; n <= CONNECT; n++) {
+        if (!weight[n]) continue;
+        bitboard count = only & ((n & 1) ? c0 : ~c0) & ((n & 2) ? c1 : ~c1) & ((n & 4) ? c2 : ~c2);
+        score += weight[n] * bbPopcount(count);
+    }
+    return score;
+}
+
+static inline int scoreDirection(bitboard bot, bitboard player, int step, bitboard start) {
+    bitboard botAny = 0, playerAny = 0;
+    for (int k = 0; k < CONNECT; k++) {
+        botAny |= bot >> (k * step);
+        playerAny |= player >> (k * step);
+    }
+    return weighRuns(bot, step, start & ~playerAny, botWeight) +
+           weighRuns(player, step, start & ~botAny, playerWeight);
+}
+
+#endif
+
+/* constant shifts, one call per direction in the order of dirStart */
+static int scoreScalar(bitboard bot, bitboard player) {
+    return bbPopcount(bot & columnMask(cols / 2)) * CENTER_WEIGHT +
+           scoreDirection(bot, player, 1, dirStart[0]) +
+           scoreDirection(bot, player, BB_H, dirStart[1]) +
+           scoreDirection(bot, player, BB_H + 1, dirStart[2]) +
+           scoreDirection(bot, player, BB_H - 1, dirStart[3]);
+}
+
+/* one call of the selected single-position kernel per position, so a
+ * batch is never slower than scoring one by one; the SIMD batch kernels
+ * finish their last few positions here */
+static void scoreBatchScalar(const bitboard *bot, const bitboard *player, int count, int *scores) {
+    for (int i = 0; i < count; i++) scores[i] = scoreKernel(bot[i], player[i]);
+}
+
+#ifdef EVAL_X86
+
+/* AVX2: one direction per 64-bit lane, so the whole board is one pass */
+__attribute__((target("avx2")))
+static inline __m256i popcount256(__m256i x) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(x, nibble));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2")))
+static int scoreAvx2(bitboard bot, bitboard player) {
+    __m256i shift1 = _mm256_loadu_si256((const __m256i *)dirShift[0]);
+    __m256i shift2 = _mm256_loadu_si256((const __m256i *)dirShift[1]);
+    __m256i shift3 = _mm256_loadu_si256((const __m256i *)dirShift[2]);
+    __m256i start = _mm256_loadu_si256((const __m256i *)dirStart);
+    __m256i sums = _mm256_setzero_si256();
+
+    for (int side = 0; side < 2; side++) {
+        __m256i x0 = _mm256_set1_epi64x((long long)(side ? player : bot));
+        __m256i y0 = _mm256_set1_epi64x((long long)(side ? bot : player));
+        const int *weight = side ? playerWeight : botWeight;
+        __m256i x1 = _mm256_srlv_epi64(x0, shift1), x2 = _mm256_srlv_epi64(x0, shift2), x3 = _mm256_srlv_epi64(x0, shift3);
+        __m256i yAny = _mm256_or_si256(_mm256_or_si256(y0, _mm256_srlv_epi64(y0, shift1)),
+                                       _mm256_or_si256(_mm256_srlv_epi64(y0, shift2), _mm256_srlv_epi64(y0, shift3)));
+        __m256i only = _mm256_andnot_si256(yAny, start);
+
+        __m256i s = _mm256_xor_si256(x0, x1), c = _mm256_and_si256(x0, x1);
+        __m256i t = _mm256_xor_si256(x2, x3), d = _mm256_and_si256(x2, x3);
+        __m256i low = _mm256_xor_si256(s, t), carry = _mm256_and_si256(s, t);
+        __m256i mid = _mm256_xor_si256(_mm256_xor_si256(c, d), carry);
+        __m256i count[5];
+        count[4] = _mm256_or_si256(_mm256_and_si256(c, d), _mm256_and_si256(carry, _mm256_xor_si256(c, d)));
+        count[3] = _mm256_and_si256(mid, low);
+        count[2] = _mm256_andnot_si256(low, mid);
+        count[1] = _mm256_andnot_si256(mid, low);
+        for (int k = 1; k <= 4; k++) {
+            if (!weight[k]) continue;
+            __m256i n = popcount256(_mm256_and_si256(count[k], only));
+            sums = _mm256_add_epi64(sums, _mm256_mul_epi32(n, _mm256_set1_epi64x(weight[k])));
+        }
+    }
+
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    half = _mm_add_epi64(half, _mm_unpackhi_epi64(half, half));
+    return __builtin_popcountll(bot & columnMask(cols / 2)) * CENTER_WEIGHT + (int)_mm_cvtsi128_si64(half);
+}
+
+/* The batch kernels put one position per lane instead, so every lane
+ * shifts by the same amount. Per-byte popcounts of the four directions
+ * add up without overflowing, so each stone count needs only one
+ * reduction and one multiply for the whole position. */
+__attribute__((target("avx2")))
+static inline __m256i byteCounts256(__m256i x) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(x, nibble));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+    return _mm256_add_epi8(lo, hi);
+}
+
+__attribute__((target("avx2")))
+static inline void countWindows256(__m256i x0, __m256i x1, __m256i x2, __m256i x3, __m256i only, __m256i bytes[5]) {
+    __m256i s = _mm256_xor_si256(x0, x1), c = _mm256_and_si256(x0, x1);
+    __m256i t = _mm256_xor_si256(x2, x3), d = _mm256_and_si256(x2, x3);
+    __m256i low = _mm256_xor_si256(s, t), carry = _mm256_and_si256(s, t);
+    __m256i mid = _mm256_xor_si256(_mm256_xor_si256(c, d), carry);
+    __m256i four = _mm256_or_si256(_mm256_and_si256(c, d), _mm256_and_si256(carry, _mm256_xor_si256(c, d)));
+    bytes[1] = _mm256_add_epi8(bytes[1], byteCounts256(_mm256_and_si256(_mm256_andnot_si256(mid, low), only)));
+    bytes[2] = _mm256_add_epi8(bytes[2], byteCounts256(_mm256_and_si256(_mm256_andnot_si256(low, mid), only)));
+    bytes[3] = _mm256_add_epi8(bytes[3], byteCounts256(_mm256_and_si256(_mm256_and_si256(mid, low), only)));
+    bytes[4] = _mm256_add_epi8(bytes[4], byteCounts256(_mm256_and_si256(four, only)));
+}
+
+__attribute__((target("avx2")))
+static inline void countDirection256(__m256i bot, __m256i player, int step, bitboard start, __m256i botBytes[5], __m256i playerBytes[5]) {
+    __m256i b1 = _mm256_srli_epi64(bot, step), b2 = _mm256_srli_epi64(bot, 2 * step), b3 = _mm256_srli_epi64(bot, 3 * step);
+    __m256i p1 = _mm256_srli_epi64(player, step), p2 = _mm256_srli_epi64(player, 2 * step), p3 = _mm256_srli_epi64(player, 3 * step);
+    __m256i starts = _mm256_set1_epi64x((long long)start);
+    __m256i botOnly = _mm256_andnot_si256(_mm256_or_si256(_mm256_or_si256(player, p1), _mm256_or_si256(p2, p3)), starts);
+    __m256i playerOnly = _mm256_andnot_si256(_mm256_or_si256(_mm256_or_si256(bot, b1), _mm256_or_si256(b2, b3)), starts);
+    countWindows256(bot, b1, b2, b3, botOnly, botBytes);
+    countWindows256(player, p1, p2, p3, playerOnly, playerBytes);
+}
+
+__attribute__((target("avx2")))
+static void scoreBatchAvx2(const bitboard *bot, const bitboard *player, int count, int *scores) {
+    const __m256i center = _mm256_set1_epi64x((long long)columnMask(cols / 2));
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i b = _mm256_loadu_si256((const __m256i *)(bot + i));
+        __m256i p = _mm256_loadu_si256((const __m256i *)(player + i));
+        __m256i botBytes[5], playerBytes[5];
+        for (int k = 1; k <= 4; k++) botBytes[k] = playerBytes[k] = zero;
+        countDirection256(b, p, 1, dirStart[0], botBytes, playerBytes);
+        countDirection256(b, p, BB_H, dirStart[1], botBytes, playerBytes);
+        countDirection256(b, p, BB_H + 1, dirStart[2], botBytes, playerBytes);
+        countDirection256(b, p, BB_H - 1, dirStart[3], botBytes, playerBytes);
+
+        __m256i sums = _mm256_mul_epi32(_mm256_sad_epu8(byteCounts256(_mm256_and_si256(b, center)), zero),
+                                        _mm256_set1_epi64x(CENTER_WEIGHT));
+        for (int k = 1; k <= 4; k++) {
+            sums = _mm256_add_epi64(sums, _mm256_mul_epi32(_mm256_sad_epu8(botBytes[k], zero), _mm256_set1_epi64x(botWeight[k])));
+            sums = _mm256_add_epi64(sums, _mm256_mul_epi32(_mm256_sad_epu8(playerBytes[k], zero), _mm256_set1_epi64x(playerWeight[k])));
+        }
+        /* the low 32 bits of each lane, in order */
+        __m256i packed = _mm256_permutevar8x32_epi32(sums, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+        _mm_storeu_si128((__m128i *)(scores + i), _mm256_castsi256_si128(packed));
+    }
+    scoreBatchScalar(bot + i, player + i, count - i, scores + i);
+}
+
+/* SSE4.1: two directions per pass; SSE only shifts both lanes by the same
+ * amount, so each lane's shift is done separately and blended */
+__attribute__((target("sse4.1")))
+static inline __m128i shiftLanes(__m128i x, const uint64_t *amount) {
+    __m128i a = _mm_srl_epi64(x, _mm_cvtsi32_si128((int)amount[0]));
+    __m128i b = _mm_srl_epi64(x, _mm_cvtsi32_si128((int)amount[1]));
+    return _mm_blend_epi16(a, b, 0xF0);
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i popcount128(__m128i x) {
+    const __m128i lut = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(x, nibble));
+    __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(x, 4), nibble));
+    return _mm_sad_epu8(_mm_add_epi8(lo, hi), _mm_setzero_si128());
+}
+
+__attribute__((target("sse4.1")))
+static int scoreSse4(bitboard bot, bitboard player) {
+    __m128i sums = _mm_setzero_si128();
+
+    for (int pair = 0; pair < DIRECTIONS; pair += 2) {
+        __m128i start = _mm_loadu_si128((const __m128i *)&dirStart[pair]);
+        for (int side = 0; side < 2; side++) {
+            __m128i x0 = _mm_set1_epi64x((long long)(side ? player : bot));
+            __m128i y0 = _mm_set1_epi64x((long long)(side ? bot : player));
+            const int *weight = side ? playerWeight : botWeight;
+            __m128i x1 = shiftLanes(x0, &dirShift[0][pair]);
+            __m128i x2 = shiftLanes(x0, &dirShift[1][pair]);
+            __m128i x3 = shiftLanes(x0, &dirShift[2][pair]);
+            __m128i yAny = _mm_or_si128(_mm_or_si128(y0, shiftLanes(y0, &dirShift[0][pair])),
+                                        _mm_or_si128(shiftLanes(y0, &dirShift[1][pair]), shiftLanes(y0, &dirShift[2][pair])));
+            __m128i only = _mm_andnot_si128(yAny, start);
+
+            __m128i s = _mm_xor_si128(x0, x1), c = _mm_and_si128(x0, x1);
+            __m128i t = _mm_xor_si128(x2, x3), d = _mm_and_si128(x2, x3);
+            __m128i low = _mm_xor_si128(s, t), carry = _mm_and_si128(s, t);
+            __m128i mid = _mm_xor_si128(_mm_xor_si128(c, d), carry);
+            __m128i count[5];
+            count[4] = _mm_or_si128(_mm_and_si128(c, d), _mm_and_si128(carry, _mm_xor_si128(c, d)));
+            count[3] = _mm_and_si128(mid, low);
+            count[2] = _mm_andnot_si128(low, mid);
+            count[1] = _mm_andnot_si128(mid, low);
+            for (int k = 1; k <= 4; k++) {
+                if (!weight[k]) continue;
+                __m128i n = popcount128(_mm_and_si128(count[k], only));
+                sums = _mm_add_epi64(sums, _mm_mul_epi32(n, _mm_set1_epi64x(weight[k])));
+            }
+        }
+    }
+
+    sums = _mm_add_epi64(sums, _mm_unpackhi_epi64(sums, sums));
+    return __builtin_popcountll(bot & columnMask(cols / 2)) * CENTER_WEIGHT + (int)_mm_cvtsi128_si64(sums);
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i byteCounts128(__m128i x) {
+    const __m128i lut = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(x, nibble));
+    __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(x, 4), nibble));
+    return _mm_add_epi8(lo, hi);
+}
+
+__attribute__((target("sse4.1")))
+static inline void countWindows128(__m128i x0, __m128i x1, __m128i x2, __m128i x3, __m128i only, __m128i bytes[5]) {
+    __m128i s = _mm_xor_si128(x0, x1), c = _mm_and_si128(x0, x1);
+    __m128i t = _mm_xor_si128(x2, x3), d = _mm_and_si128(x2, x3);
+    __m128i low = _mm_xor_si128(s, t), carry = _mm_and_si128(s, t);
+    __m128i mid = _mm_xor_si128(_mm_xor_si128(c, d), carry);
+    __m128i four = _mm_or_si128(_mm_and_si128(c, d), _mm_and_si128(carry, _mm_xor_si128(c, d)));
+    bytes[1] = _mm_add_epi8(bytes[1], byteCounts128(_mm_and_si128(_mm_andnot_si128(mid, low), only)));
+    bytes[2] = _mm_add_epi8(bytes[2], byteCounts128(_mm_and_si128(_mm_andnot_si128(low, mid), only)));
+    bytes[3] = _mm_add_epi8(bytes[3], byteCounts128(_mm_and_si128(_mm_and_si128(mid, low), only)));
+    bytes[4] = _mm_add_epi8(bytes[4], byteCounts128(_mm_and_si128(four, only)));
+}
+
+__attribute__((target("sse4.1")))
+static inline void countDirection128(__m128i bot, __m128i player, int step, bitboard start, __m128i botBytes[5], __m128i playerBytes[5]) {
+    __m128i b1 = _mm_srli_epi64(bot, step), b2 = _mm_srli_epi64(bot, 2 * step), b3 = _mm_srli_epi64(bot, 3 * step);
+    __m128i p1 = _mm_srli_epi64(player, step), p2 = _mm_srli_epi64(player, 2 * step), p3 = _mm_srli_epi64(player, 3 * step);
+    __m128i starts = _mm_set1_epi64x((long long)start);
+    __m128i botOnly = _mm_andnot_si128(_mm_or_si128(_mm_or_si128(player, p1), _mm_or_si128(p2, p3)), starts);
+    __m128i playerOnly = _mm_andnot_si128(_mm_or_si128(_mm_or_si128(bot, b1), _mm_or_si128(b2, b3)), starts);
+    countWindows128(bot, b1, b2, b3, botOnly, botBytes);
+    countWindows128(player, p1, p2, p3, playerOnly, playerBytes);
+}
+
+__attribute__((target("sse4.1")))
+static void scoreBatchSse4(const bitboard *bot, const bitboard *player, int count, int *scores) {
+    const __m128i center = _mm_set1_epi64x((long long)columnMask(cols / 2));
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i b = _mm_loadu_si128((const __m128i *)(bot + i));
+        __m128i p = _mm_loadu_si128((const __m128i *)(player + i));
+        __m128i botBytes[5], playerBytes[5];
+        for (int k = 1; k <= 4; k++) botBytes[k] = playerBytes[k] = zero;
+        countDirection128(b, p, 1, dirStart[0], botBytes, playerBytes);
+        countDirection128(b, p, BB_H, dirStart[1], botBytes, playerBytes);
+        countDirection128(b, p, BB_H + 1, dirStart[2], botBytes, playerBytes);
+        countDirection128(b, p, BB_H - 1, dirStart[3], botBytes, playerBytes);
+
+        __m128i sums = _mm_mul_epi32(_mm_sad_epu8(byteCounts128(_mm_and_si128(b, center)), zero),
+                                     _mm_set1_epi64x(CENTER_WEIGHT));
+        for (int k = 1; k <= 4; k++) {
+            sums = _mm_add_epi64(sums, _mm_mul_epi32(_mm_sad_epu8(botBytes[k], zero), _mm_set1_epi64x(botWeight[k])));
+            sums = _mm_add_epi64(sums, _mm_mul_epi32(_mm_sad_epu8(playerBytes[k], zero), _mm_set1_epi64x(playerWeight[k])));
+        }
+        scores[i] = _mm_cvtsi128_si32(sums);
+        scores[i + 1] = _mm_extract_epi32(sums, 2);
+    }
+    scoreBatchScalar(bot + i, player + i, count - i, scores + i);
+}
+
+#endif
+
+bool evalKernelSupported(int kernel) {
+#ifdef EVAL_X86
+    __builtin_cpu_init();
+    if (kernel == EVAL_KERNEL_AVX2) return __builtin_cpu_supports("avx2");
+    if (kernel == EVAL_KERNEL_SSE4) return __builtin_cpu_supports("sse4.1");
+#endif
+    return kernel == EVAL_KERNEL_SCALAR;
+}
+
+int evalBestKernel(void) {
+    if (evalKernelSupported(EVAL_KERNEL_AVX2)) return EVAL_KERNEL_AVX2;
+    if (evalKernelSupported(EVAL_KERNEL_SSE4)) return EVAL_KERNEL_SSE4;
+    return EVAL_KERNEL_SCALAR;
+}
+
+bool evalSelectKernel(int kernel) {
+    if (!evalKernelSupported(kernel)) return false;
+    scoreKernel = scoreScalar;
+    batchKernel = scoreBatchScalar;
+#ifdef EVAL_X86
+    if (kernel == EVAL_KERNEL_AVX2) {
+        scoreKernel = scoreAvx2;
+        batchKernel = scoreBatchAvx2;
+    }
+    if (kernel == EVAL_KERNEL_SSE4) {
+        scoreKernel = scoreSse4;
+        batchKernel = scoreBatchSse4;
+    }
+#endif
+    activeKernel = kernel;
+    return true;
+}
+
+int evalKernel(void) { return activeKernel; }
+
+const char *evalKernelName(int kernel) {
+    if (kernel == EVAL_KERNEL_AVX2) return "avx2";
+    if (kernel == EVAL_KERNEL_SSE4) return "sse4.1";
+    return "scalar";
+}
+
+int scorePosition(bitboard bot, bitboard player) {
+    return scoreKernel(bot, player);
+}
+
+void scorePositions(const bitboard *bot, const bitboard *player, int count, int *scores) {
+    batchKernel(bot, player, count, scores);
+}
+
+void evalInit(Evaluator *ev, const Position *pos) {
+    /* colour of the side to move is moves & 1 */
+    int toMove = pos->moves & 1;
+    bitboard stones[2];
+    stones[toMove] = pos->current;
+    stones[!toMove] = pos->current ^ pos->mask;
+
+    for (int k = 0; k < 2; k++)
+        for (int w = 0; w < WINDOW_COUNT; w++)
+            ev->count[k][w] = (uint8_t)bbPopcount(stones[k] & windows[w]);
+    ev->score[0] = scorePosition(stones[0], stones[1]);
+    ev->score[1] = scorePosition(stones[1], stones[0]);
+}
+
+void evalPlay(Evaluator *ev, int colour, int cell) {
+    uint8_t *own = ev->count[colour];
+    uint8_t *other = ev->count[!colour];
+    for (int i = 0; i < cellWindowCount[cell]; i++) {
+        int w = cellWindows[cell][i];
+        ev->score[colour] += ownDelta[own[w]][other[w]];
+        ev->score[!colour] += otherDelta[own[w]][other[w]];
+        own[w]++;
+    }
+    if (cell / BB_H == cols / 2) ev->score[colour] += CENTER_WEIGHT;
+}
+
+void evalUndo(Evaluator *ev, int colour, int cell) {
+    uint8_t *own = ev->count[colour];
+    uint8_t *other = ev->count[!colour];
+    for (int i = 0; i < cellWindowCount[cell]; i++) {
+        int w = cellWindows[cell][i];
+        own[w]--;
+        ev->score[colour] -= ownDelta[own[w]][other[w]];
+        ev->score[!colour] -= otherDelta[own[w]][other[w]];
+    }
+    if (cell / BB_H == cols / 2) ev->score[colour] -= CENTER_WEIGHT;
+}
@@ -0,0 +1,47 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "bitboard.h"
+
+#define WINDOW_COUNT ((rows * (cols - CONNECT + 1)) + (cols * (rows - CONNECT + 1)) + \
+                      2 * ((rows - CONNECT + 1) * (cols - CONNECT + 1)))
+#define CENTER_WEIGHT 6
+
+/* Heuristic score kept up to date as stones are added and removed. Every
+ * window of CONNECT cells has a stone count per colour; a move only touches
+ * the (at most 4 * CONNECT) windows through its cell. */
+typedef struct {
+    uint8_t count[2][WINDOW_COUNT];
+    int score[2];       /* scorePosition() as seen by each colour */
+} Evaluator;
+
+extern bitboard windows[WINDOW_COUNT];
+extern int windowScore[CONNECT + 1][CONNECT + 1];
+
+void evalTablesInit(void);
+
+/* Full rescan, [bot stones, player stones] -> score. It runs on the
+ * fastest kernel the CPU supports, picked by evalTablesInit(); every
+ * kernel returns exactly what scorePositionWindows() does. */
+enum { EVAL_KERNEL_SCALAR, EVAL_KERNEL_SSE4, EVAL_KERNEL_AVX2 };
+
+int scorePosition(bitboard bot, bitboard player);
+int scorePositionWindows(bitboard bot, bitboard player);
+
+/* scores[i] = scorePosition(bot[i], player[i]); the positions are laid out
+ * as two arrays so the SIMD kernels score a register of them at a time */
+void scorePositions(const bitboard *bot, const bitboard *player, int count, int *scores);
+
+bool evalKernelSupported(int kernel);
+int evalBestKernel(void);
+bool evalSelectKernel(int kernel);      /* false if the CPU lacks it */
+int evalKernel(void);
+const char *evalKernelName(int kernel);
+
+void evalInit(Evaluator *ev, const Position *pos);
+void evalPlay(Evaluator *ev, int colour, int cell);
+void evalUndo(Evaluator *ev, int colour, int cell);
+
+static inline int evalScore(const Evaluator *ev, int colour) { return ev->score[colour]; }
+
+#endif
@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "engine.h"
+
+/* Times the full-board evaluation on the same random positions: the
+ * original char-board scorePosition the bitboards replaced, the bitboard
+ * window loop and every kernel this CPU supports, one position per call
+ * and in batches. Everything is checked against the original first and a
+ * mismatch fails the run; speedups are against the original too.
+ * Usage: evalbench [positions=100000] [rounds=50] */
+
+#define BOT_CELL 'O'
+#define PLAYER_CELL 'X'
+
+typedef struct {
+    bitboard bot, player;
+} Stones;
+
+typedef struct {
+    char cells[rows][cols];
+} CharBoard;
+
+/* evaluateWindow and scorePosition as connect4.c had them before the
+ * bitboards, unchanged but for the names */
+static int charEvaluateWindow(char window[4], char bot, char player) {
+    int score = 0;
+    int botCount = 0, playerCount = 0, emptyCount = 0;
+    for (int i = 0; i < 4; i++) {
+        if (window[i] == bot) botCount++;
+        else if (window[i] == player) playerCount++;
+        else emptyCount++;
+    }
+
+    if (botCount == 4) score += 10000;
+    else if (botCount == 3 && emptyCount == 1) score += 100;
+    else if (botCount == 2 && emptyCount == 2) score += 10;
+
+    if (playerCount == 3 && emptyCount == 1) score -= 900;
+    else if (playerCount == 2 && emptyCount == 2) score -= 20;
+
+    return score;
+}
+
+static int charScorePosition(char board[rows][cols], char bot, char player) {
+    int score = 0;
+
+    int centerCol = cols / 2;
+    int centerCount = 0;
+    for (int r = 0; r < rows; r++)
+        if (board[r][centerCol] == bot) centerCount++;
+    score += centerCount * 6;
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c <= cols - 4; c++) {
+            char window[4];
+            for (int k = 0; k < 4; k++) window[k] = board[r][c + k];
+            score += charEvaluateWindow(window, bot, player);
+        }
+    }
+
+    for (int c = 0; c < cols; c++) {
+        for (int r = 0; r <= rows - 4; r++) {
+            char window[4];
+            for (int k = 0; k < 4; k++) window[k] = board[r + k][c];
+            score += charEvaluateWindow(window, bot, player);
+        }
+    }
+
+    for (int r = 3; r < rows; r++) {
+        for (int c = 0; c <= cols - 4; c++) {
+            char window[4];
+            for (int k = 0; k < 4; k++) window[k] = board[r - k][c + k];
+            score += charEvaluateWindow(window, bot, player);
+        }
+    }
+
+    for (int r = 0; r <= rows - 4; r++) {
+        for (int c = 0; c <= cols - 4; c++) {
+            char window[4];
+            for (int k = 0; k < 4; k++) window[k] = board[r + k][c + k];
+            score += charEvaluateWindow(window, bot, player);
+        }
+    }
+
+    return score;
+}
+
+/* row 0 of the char board is the top, bit 0 of a column the bottom */
+static void toCharBoard(const Stones *s, CharBoard *b) {
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            bitboard cell = (bitboard)1 << (c * BB_H + rows - 1 - r);
+            b->cells[r][c] = (s->bot & cell) ? BOT_CELL : (s->player & cell) ? PLAYER_CELL : '.';
+        }
+    }
+}
+
+typedef int (*ScoreFn)(bitboard bot, bitboard player);
+
+/* random games cut at a random length, in both colour orders */
+static void randomPositions(Stones *out, int count) {
+    bitboard seed = 0x241E7A1;
+    for (int i = 0; i < count; i++) {
+        Position pos;
+        positionInit(&pos);
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        int length = (int)((seed >> 33) % (rows * cols));
+        while (pos.moves < length) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            int col = (int)((seed >> 33) % cols);
+            if (!canPlay(&pos, col)) continue;
+            playMove(&pos, col);
+        }
+        out[i].bot = pos.current;
+        out[i].player = pos.current ^ pos.mask;
+    }
+}
+
+static double timeNs(ScoreFn fn, const Stones *pos, int count, int rounds, long long *checksum) {
+    long long sum = 0;
+    long long start = monotonicNs();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < count; i++) sum += fn(pos[i].bot, pos[i].player);
+    long long elapsed = monotonicNs() - start;
+    *checksum = sum;
+    return (double)elapsed / ((double)count * rounds);
+}
+
+static double timeCharNs(CharBoard *boards, int count, int rounds, long long *checksum) {
+    long long sum = 0;
+    long long start = monotonicNs();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < count; i++) sum += charScorePosition(boards[i].cells, BOT_CELL, PLAYER_CELL);
+    long long elapsed = monotonicNs() - start;
+    *checksum = sum;
+    return (double)elapsed / ((double)count * rounds);
+}
+
+/* the same positions split into the two arrays scorePositions() takes */
+static double timeBatchNs(const bitboard *bot, const bitboard *player, int *scores, int count, int rounds, long long *checksum) {
+    long long sum = 0;
+    long long start = monotonicNs();
+    for (int r = 0; r < rounds; r++) {
+        scorePositions(bot, player, count, scores);
+        for (int i = 0; i < count; i++) sum += scores[i];
+    }
+    long long elapsed = monotonicNs() - start;
+    *checksum = sum;
+    return (double)elapsed / ((double)count * rounds);
+}
+
+int main(int argc, char **argv) {
+    int count = argc >= 2 ? atoi(argv[1]) : 100000;
+    int rounds = argc >= 3 ? atoi(argv[2]) : 50;
+    if (count <= 0 || rounds <= 0) {
+        printf("Usage: %s [positions] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    engineInit();
+    Stones *pos = malloc(count * sizeof(Stones));
+    bitboard *bot = malloc(count * sizeof(bitboard));
+    bitboard *player = malloc(count * sizeof(bitboard));
+    int *scores = malloc(count * sizeof(int));
+    CharBoard *boards = malloc(count * sizeof(CharBoard));
+    int *original = malloc(count * sizeof(int));
+    int *swapped = malloc(count * sizeof(int));
+    if (!pos || !bot || !player || !scores || !boards || !original || !swapped) {
+        printf("Not enough memory for %d positions.\n", count);
+        return 1;
+    }
+    randomPositions(pos, count);
+    for (int i = 0; i < count; i++) {
+        bot[i] = pos[i].bot;
+        player[i] = pos[i].player;
+        toCharBoard(&pos[i], &boards[i]);
+        /* both colour orders, as the search scores either side */
+        original[i] = charScorePosition(boards[i].cells, BOT_CELL, PLAYER_CELL);
+        swapped[i] = charScorePosition(boards[i].cells, PLAYER_CELL, BOT_CELL);
+    }
+
+    long long expected;
+    double base = timeCharNs(boards, count, rounds, &expected);
+    printf("%-8s %8.2f ns/position\n", "original", base);
+
+    int failures = 0;
+    int windowMismatches = 0;
+    for (int i = 0; i < count; i++) {
+        if (scorePositionWindows(pos[i].bot, pos[i].player) != original[i] ||
+            scorePositionWindows(pos[i].player, pos[i].bot) != swapped[i])
+            windowMismatches++;
+    }
+    long long windowChecksum;
+    double windowNs = timeNs(scorePositionWindows, pos, count, rounds, &windowChecksum);
+    printf("%-8s %8.2f ns/position  %.1fx  %d mismatches%s\n", "windows", windowNs, base / windowNs,
+           windowMismatches, windowChecksum == expected ? "" : "  CHECKSUM DIFFERS");
+    if (windowMismatches || windowChecksum != expected) failures++;
+
+    for (int kernel = EVAL_KERNEL_SCALAR; kernel <= EVAL_KERNEL_AVX2; kernel++) {
+        if (!evalSelectKernel(kernel)) {
+            printf("%-8s not supported on this CPU\n", evalKernelName(kernel));
+            continue;
+        }
+        int mismatches = 0;
+        for (int i = 0; i < count; i++) {
+            if (scorePosition(pos[i].bot, pos[i].player) != original[i] ||
+                scorePosition(pos[i].player, pos[i].bot) != swapped[i])
+                mismatches++;
+        }
+        scorePositions(bot, player, count, scores);
+        for (int i = 0; i < count; i++)
+            if (scores[i] != original[i]) mismatches++;
+
+        long long checksum, batchChecksum;
+        double ns = timeNs(scorePosition, pos, count, rounds, &checksum);
+        double batchNs = timeBatchNs(bot, player, scores, count, rounds, &batchChecksum);
+        printf("%-8s %8.2f ns/position  %.1fx   batch %6.2f ns/position  %.1fx  %d mismatches%s\n",
+               evalKernelName(kernel), ns, base / ns, batchNs, base / batchNs, mismatches,
+               checksum == expected && batchChecksum == expected ? "" : "  CHECKSUM DIFFERS");
+        if (mismatches || checksum != expected || batchChecksum != expected) failures++;
+    }
+    evalSelectKernel(evalBestKernel());
+
+    free(pos);
+    free(bot);
+    free(player);
+    free(scores);
+    free(boards);
+    free(original);
+    free(swapped);
+    return failures ? 1 : 0;
+}
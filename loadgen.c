@@ -0,0 +1,445 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include "bot.h"
+#include "protocol.h"
+
+/* Plays many games at once against a multi-game server (server --multi)
+ * to measure it: every simulated client is one connection, and a client
+ * whose game ends starts the next one right away. It runs for a number of
+ * seconds or of games and reports games and moves per second and the
+ * round-trip time of a move: from sending the client's move to receiving
+ * the server's answer, the server's thinking included.
+ * Usage: loadgen [port] [--host ip] [--clients N] [--seconds N | --games N]
+ *                [--moves random|easy|medium|hard] [--ms N] [--script file]
+ *                [--compact] [--seed N]
+ * The clients' moves are random, the bot's at that difficulty (--ms per
+ * move for hard), or from a script: one game per line, the client's
+ * columns (1-7) in order, random once a line runs out or a move is full.
+ * --compact uses the compact protocol (protocol.h); give the compact port.
+ * All clients run on one thread, so a bot's thinking delays reading the
+ * other clients' answers: measure the server with random moves. Connects
+ * do not block either; one that fails counts as an error, and the client
+ * tries again LOADGEN_RETRY_MS later, up to LOADGEN_MAX_RETRIES times in a
+ * row before it gives up. */
+
+#define LOADGEN_DEFAULT_CLIENTS 100
+#define LOADGEN_DEFAULT_SECONDS 10
+#define LOADGEN_DEFAULT_MS 10
+#define LOADGEN_MAX_EVENTS 256
+#define LOADGEN_MAX_SCRIPT 64
+#define LOADGEN_RETRY_MS 100
+#define LOADGEN_MAX_RETRIES 50
+
+#define FRAME_SIZE (rows * cols + 8)    /* the legacy board, status and yourTurn */
+
+typedef struct Client {
+    int fd;
+    bool connecting;            /* the connect is not through yet */
+    bool gotMode;               /* legacy: the mode int came */
+    int ply;                    /* compact: stones on the board */
+    char board[rows][cols];
+    unsigned char in[MSG_MAX + 1];
+    int inLen;
+    long long sentAt;           /* the client's move is out since; 0 if none */
+    const char *script;         /* the line of this game, NULL if none */
+    int scriptPos;
+    int failures;               /* connects that failed in a row */
+    long long retryAt;          /* on the retry list: monotonic ns of the next connect */
+    struct Client *nextRetry;
+} Client;
+
+typedef struct {
+    struct sockaddr_in addr;
+    int epoll;
+    bool compact;
+    int moveMode;               /* 0 random, else BOT_EASY .. BOT_HARD */
+    Bot bot;                    /* every client's, they take turns on one thread */
+    char **script;              /* lines of the script file */
+    int scriptLines;
+    unsigned seed;
+    int gameLimit;              /* 0: until the deadline */
+    long long deadline;         /* monotonic ns, 0: until gameLimit */
+    bool stopping;
+    long long started, finished, open, errors;
+    long long connecting;       /* connects issued and not through yet */
+    Client *retry;              /* clients waiting to connect again */
+    long long serverWins, clientWins, draws;
+    long long moves;            /* both sides' */
+    long long *latencies;       /* ns per round trip */
+    long long latencyCount, latencyCapacity;
+} LoadGen;
+
+static void recordLatency(LoadGen *lg, long long ns) {
+    if (lg->latencyCount == lg->latencyCapacity) {
+        long long capacity = lg->latencyCapacity ? 2 * lg->latencyCapacity : 1 << 16;
+        long long *grown = realloc(lg->latencies, capacity * sizeof(long long));
+        if (!grown) return;
+        lg->latencies = grown;
+        lg->latencyCapacity = capacity;
+    }
+    lg->latencies[lg->latencyCount++] = ns;
+}
+
+/* highest empty row of col, -1 if full */
+static int freeRow(char board[rows][cols], int col) {
+    if (col < 0 || col >= cols) return -1;
+    for (int i = rows - 1; i >= 0; i--)
+        if (board[i][col] == '.') return i;
+    return -1;
+}
+
+static int randomMove(LoadGen *lg, char board[rows][cols]) {
+    int col;
+    do {
+        col = rand_r(&lg->seed) % cols;
+    } while (freeRow(board, col) < 0);
+    return col;
+}
+
+/* the next script column if it can be played, otherwise a move of the
+ * configured kind */
+static int chooseMove(LoadGen *lg, Client *c) {
+    if (c->script && c->script[c->scriptPos]) {
+        int col = c->script[c->scriptPos++] - '1';
+        if (freeRow(c->board, col) >= 0) return col;
+    }
+    if (lg->moveMode == 0) return randomMove(lg, c->board);
+    BotChoice why;
+    int col = botChoose(&lg->bot, c->board, 'O', &why);
+    return freeRow(c->board, col) >= 0 ? col : randomMove(lg, c->board);
+}
+
+static void closeClient(LoadGen *lg, Client *c) {
+    epoll_ctl(lg->epoll, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    c->fd = -1;
+    lg->open--;
+}
+
+/* an error; c goes on the retry list unless it has failed too often */
+static void connectFailed(LoadGen *lg, Client *c) {
+    lg->errors++;
+    if (++c->failures >= LOADGEN_MAX_RETRIES) return;
+    c->retryAt = monotonicNs() + LOADGEN_RETRY_MS * 1000000LL;
+    c->nextRetry = lg->retry;
+    lg->retry = c;
+}
+
+/* a new game on c, unless the run is over; its connect completes on
+ * EPOLLOUT, see finishConnect */
+static void startGame(LoadGen *lg, Client *c) {
+    if (lg->stopping || (lg->gameLimit && lg->started + lg->connecting >= lg->gameLimit)) return;
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    struct epoll_event ev = { .events = EPOLLOUT, .data.ptr = c };
+    if (fd < 0 || (connect(fd, (struct sockaddr*)&lg->addr, sizeof(lg->addr)) < 0 && errno != EINPROGRESS) ||
+        epoll_ctl(lg->epoll, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        if (fd >= 0) close(fd);
+        connectFailed(lg, c);
+        return;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    *c = (Client){ .fd = fd, .connecting = true, .failures = c->failures };
+    memset(c->board, '.', sizeof(c->board));
+    lg->connecting++;
+    lg->open++;
+}
+
+/* c's connect is through or failed; through, the game counts as started
+ * and c waits for the server */
+static void finishConnect(LoadGen *lg, Client *c) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+    bool ok = getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && !err &&
+              epoll_ctl(lg->epoll, EPOLL_CTL_MOD, c->fd, &ev) == 0;
+    if (ok && lg->compact) {
+        unsigned char hello[MSG_HELLO_SIZE];
+        msgHello(hello);
+        ok = send(c->fd, hello, sizeof(hello), MSG_NOSIGNAL) == sizeof(hello);
+    }
+    lg->connecting--;
+    if (!ok) {
+        closeClient(lg, c);
+        connectFailed(lg, c);
+        return;
+    }
+    c->connecting = false;
+    c->failures = 0;
+    if (lg->scriptLines) c->script = lg->script[lg->started % lg->scriptLines];
+    lg->started++;
+}
+
+/* starts the clients on the retry list whose wait is over */
+static void retryClients(LoadGen *lg) {
+    Client *c = lg->retry;
+    long long now = monotonicNs();
+    lg->retry = NULL;
+    while (c) {
+        Client *next = c->nextRetry;
+        if (now >= c->retryAt) {
+            startGame(lg, c);
+        } else {
+            c->nextRetry = lg->retry;
+            lg->retry = c;
+        }
+        c = next;
+    }
+}
+
+static void endGame(LoadGen *lg, Client *c, int status) {
+    if (status == 1) lg->serverWins++;
+    else if (status == 2) lg->clientWins++;
+    else lg->draws++;
+    lg->finished++;
+    closeClient(lg, c);
+}
+
+/* The server's word after the client's move or its own. A round trip ends
+ * when the server hands the turn back or the game is over; false if the
+ * client could not answer. */
+static bool serverSaid(LoadGen *lg, Client *c, int status, int yourTurn) {
+    if (c->sentAt && (status != 0 || yourTurn)) {
+        recordLatency(lg, monotonicNs() - c->sentAt);
+        c->sentAt = 0;
+    }
+    if (status != 0) {
+        endGame(lg, c, status);
+        return true;
+    }
+    if (!yourTurn) return true;
+
+    int col = chooseMove(lg, c);
+    unsigned char out[MSG_PLAY_SIZE];
+    int n;
+    if (lg->compact) {
+        n = msgPlay(out, c->ply, col);
+        c->ply++;
+    } else {
+        int32_t net = htonl(col);
+        memcpy(out, &net, sizeof(net));
+        n = sizeof(net);
+    }
+    c->board[freeRow(c->board, col)][col] = 'O';
+    lg->moves++;
+    c->sentAt = monotonicNs();
+    return send(c->fd, out, n, MSG_NOSIGNAL) == n;
+}
+
+/* every whole legacy frame in c->in; how much of it was used, -1 on error */
+static int legacyInput(LoadGen *lg, Client *c) {
+    int used = 0;
+    if (!c->gotMode) {
+        if (c->inLen < 4) return 0;
+        c->gotMode = true;
+        used = 4;
+    }
+    while (c->fd >= 0 && c->inLen - used >= FRAME_SIZE) {
+        const unsigned char *f = c->in + used;
+        int32_t net[2];
+        memcpy(net, f + rows * cols, sizeof(net));
+        /* the server's stone is the one more X than before */
+        for (int i = 0; i < rows * cols; i++)
+            if (f[i] == 'X' && ((char*)c->board)[i] != 'X') lg->moves++;
+        memcpy(c->board, f, sizeof(c->board));
+        used += FRAME_SIZE;
+        if (!serverSaid(lg, c, (int)ntohl(net[0]), (int)ntohl(net[1]))) return -1;
+    }
+    return used;
+}
+
+/* every whole compact message in c->in; as legacyInput */
+static int compactInput(LoadGen *lg, Client *c) {
+    int used = 0, size;
+    while (c->fd >= 0 && (size = msgComplete(c->in + used, c->inLen - used)) > 0) {
+        const unsigned char *m = c->in + used;
+        used += size;
+        int status, yourTurn;
+        if (m[1] == MSG_BOARD && size == MSG_BOARD_SIZE) {
+            c->ply = m[8];
+            status = m[9];
+            yourTurn = m[10];
+            memcpy(c->board, m + 11, sizeof(c->board));
+        } else if (m[1] == MSG_MOVE && size == MSG_MOVE_SIZE) {
+            status = m[8];
+            yourTurn = m[9];
+            /* anything but the echo of the client's last move is the server's */
+            if (m[6] == c->ply) {
+                int row = freeRow(c->board, m[7]);
+                if (row < 0) return -1;
+                c->board[row][m[7]] = 'X';
+                c->ply++;
+                lg->moves++;
+            }
+        } else {
+            return -1;
+        }
+        if (!serverSaid(lg, c, status, yourTurn)) return -1;
+    }
+    return used;
+}
+
+static void readClient(LoadGen *lg, Client *c) {
+    ssize_t n = recv(c->fd, c->in + c->inLen, sizeof(c->in) - c->inLen, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+    int used = -1;
+    if (n > 0) {
+        c->inLen += n;
+        used = lg->compact ? compactInput(lg, c) : legacyInput(lg, c);
+    }
+    if (c->fd < 0) return;      /* the game is over */
+    if (used < 0) {
+        /* the server hung up mid-game or sent nonsense */
+        lg->errors++;
+        closeClient(lg, c);
+        return;
+    }
+    memmove(c->in, c->in + used, c->inLen - used);
+    c->inLen -= used;
+}
+
+/* one line per game, the client's columns; false if the file cannot be read */
+static bool loadScript(LoadGen *lg, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) { perror("fopen"); return false; }
+    char line[LOADGEN_MAX_SCRIPT + 2];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, " \t\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+        char **grown = realloc(lg->script, (lg->scriptLines + 1) * sizeof(char*));
+        if (!grown || !(grown[lg->scriptLines] = strdup(line))) { fclose(f); return false; }
+        lg->script = grown;
+        lg->scriptLines++;
+    }
+    fclose(f);
+    return lg->scriptLines > 0;
+}
+
+static int compareLongLong(const void *a, const void *b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentileMs(const long long *sorted, long long n, double q) {
+    long long i = (long long)(q * n);
+    if (i >= n) i = n - 1;
+    return sorted[i] / 1e6;
+}
+
+int main(int argc, char **argv) {
+    LoadGen lg = { .seed = (unsigned)time(NULL) };
+    const char *host = "127.0.0.1", *moves = "random", *scriptPath = NULL;
+    int port = 9000, clientCount = LOADGEN_DEFAULT_CLIENTS, seconds = 0, budgetMs = LOADGEN_DEFAULT_MS;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) host = argv[++i];
+        else if (strcmp(argv[i], "--clients") == 0 && i + 1 < argc) clientCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) lg.gameLimit = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--moves") == 0 && i + 1 < argc) moves = argv[++i];
+        else if (strcmp(argv[i], "--ms") == 0 && i + 1 < argc) budgetMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) scriptPath = argv[++i];
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) lg.seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--compact") == 0) lg.compact = true;
+        else if (argv[i][0] != '-') port = atoi(argv[i]);
+        else {
+            printf("Unexpected argument '%s'.\n", argv[i]);
+            return 1;
+        }
+    }
+    if (strcmp(moves, "easy") == 0) lg.moveMode = BOT_EASY;
+    else if (strcmp(moves, "medium") == 0) lg.moveMode = BOT_MEDIUM;
+    else if (strcmp(moves, "hard") == 0) lg.moveMode = BOT_HARD;
+    else if (strcmp(moves, "random") != 0) {
+        printf("Moves are random, easy, medium or hard.\n");
+        return 1;
+    }
+    if (clientCount < 1 || budgetMs < 1 || seconds < 0 || lg.gameLimit < 0) {
+        printf("Usage: %s [port] [--host ip] [--clients N] [--seconds N | --games N] "
+               "[--moves random|easy|medium|hard] [--ms N] [--script file] [--compact] [--seed N]\n", argv[0]);
+        return 1;
+    }
+    if (!seconds && !lg.gameLimit) seconds = LOADGEN_DEFAULT_SECONDS;
+    if (lg.gameLimit && clientCount > lg.gameLimit) clientCount = lg.gameLimit;
+
+    lg.addr = (struct sockaddr_in){ .sin_family = AF_INET, .sin_port = htons(port) };
+    if (inet_pton(AF_INET, host, &lg.addr.sin_addr) <= 0) { printf("Bad address '%s'.\n", host); return 1; }
+    if (scriptPath && !loadScript(&lg, scriptPath)) { printf("No moves in '%s'.\n", scriptPath); return 1; }
+    if (lg.moveMode) {
+        engineInit();
+        if (!botInit(&lg.bot, lg.moveMode, NULL, lg.seed)) { printf("Not enough memory for the bot's tables.\n"); return 1; }
+        lg.bot.budgetMs = budgetMs;
+    }
+    Client *clients = calloc(clientCount, sizeof(Client));
+    lg.epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (!clients || lg.epoll < 0) { printf("Out of memory.\n"); return 1; }
+
+    printf("%d clients on %s:%d, %s protocol, %s moves%s, ", clientCount, host, port,
+           lg.compact ? "compact" : "legacy", moves, scriptPath ? " after the script" : "");
+    if (lg.gameLimit) printf("%d games\n", lg.gameLimit);
+    else printf("%d s\n", seconds);
+    fflush(stdout);
+
+    long long start = monotonicNs();
+    if (seconds) lg.deadline = start + seconds * 1000000000LL;
+    for (int i = 0; i < clientCount; i++) {
+        clients[i].fd = -1;
+        startGame(&lg, &clients[i]);
+    }
+
+    struct epoll_event events[LOADGEN_MAX_EVENTS];
+    while (lg.open > 0 || lg.retry) {
+        int n = epoll_wait(lg.epoll, events, LOADGEN_MAX_EVENTS, LOADGEN_RETRY_MS);
+        if (n < 0 && errno != EINTR) { perror("epoll_wait"); return 1; }
+        for (int i = 0; i < n; i++) {
+            Client *c = events[i].data.ptr;
+            if (c->fd >= 0 && c->connecting) {
+                finishConnect(&lg, c);
+                continue;
+            }
+            if (c->fd >= 0) readClient(&lg, c);
+            /* a client whose game is over plays the next one */
+            if (c->fd < 0) startGame(&lg, c);
+        }
+        retryClients(&lg);
+        /* games still running at the deadline are not counted */
+        if (lg.deadline && monotonicNs() >= lg.deadline) {
+            lg.stopping = true;
+            lg.retry = NULL;
+            for (int i = 0; i < clientCount; i++)
+                if (clients[i].fd >= 0) closeClient(&lg, &clients[i]);
+        }
+    }
+    double elapsed = (monotonicNs() - start) / 1e9;
+
+    printf("%lld games (server %lld, client %lld, draws %lld), %lld errors in %.1f s\n",
+           lg.finished, lg.serverWins, lg.clientWins, lg.draws, lg.errors, elapsed);
+    printf("%.1f games/s, %.1f moves/s\n", lg.finished / elapsed, lg.moves / elapsed);
+    if (lg.latencyCount) {
+        qsort(lg.latencies, lg.latencyCount, sizeof(long long), compareLongLong);
+        printf("Move round trip over %lld moves: p50 %.3f ms, p99 %.3f ms, p999 %.3f ms, max %.3f ms\n",
+               lg.latencyCount, percentileMs(lg.latencies, lg.latencyCount, 0.5),
+               percentileMs(lg.latencies, lg.latencyCount, 0.99),
+               percentileMs(lg.latencies, lg.latencyCount, 0.999),
+               lg.latencies[lg.latencyCount - 1] / 1e6);
+    }
+
+    if (lg.moveMode) botFree(&lg.bot);
+    for (int i = 0; i < lg.scriptLines; i++) free(lg.script[i]);
+    free(lg.script);
+    free(lg.latencies);
+    free(clients);
+    close(lg.epoll);
+    return 0;
+}
@@ -6,8 +6,8 @@
 #include <string.h>
 #include <pthread.h>
 
-#define rows 6
-#define cols 7
+#include "bot.h"
+#include "parallel.h"
 
 void initialize(char board[rows][cols]) {
     for (int i = 0; i < rows; i++)
@@ -39,46 +39,21 @@ bool update(char board[rows][cols], int col, char player) {
 }
 
 bool checkWin(char board[rows][cols], char player) {
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j <= cols - 4; j++) {
-            if (board[i][j] == player &&
-                board[i][j + 1] == player &&
-                board[i][j + 2] == player &&
-                board[i][j + 3] == player)
-                return true;
-        }
-    }
-
-    for (int j = 0; j < cols; j++) {
-        for (int i = 0; i <= rows - 4; i++) {
-            if (board[i][j] == player &&
-                board[i + 1][j] == player &&
-                board[i + 2][j] == player &&
-                board[i + 3][j] == player)
-                return true;
-        }
-    }
-
-    for (int i = 3; i < rows; i++) {
-        for (int j = 0; j <= cols - 4; j++) {
-            if (board[i][j] == player &&
-                board[i - 1][j + 1] == player &&
-                board[i - 2][j + 2] == player &&
-                board[i - 3][j + 3] == player)
-                return true;
-        }
-    }
-
-    for (int i = 0; i <= rows - 4; i++) {
-        for (int j = 0; j <= cols - 4; j++) {
-            if (board[i][j] == player &&
-                board[i + 1][j + 1] == player &&
-                board[i + 2][j + 2] == player &&
-                board[i + 3][j + 3] == player)
-                return true;
+    /* right, down, up-right and down-right from every cell */
+    static const int dirs[4][2] = { {0, 1}, {1, 0}, {-1, 1}, {1, 1} };
+    for (int d = 0; d < 4; d++) {
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                int k = 0;
+                while (k < CONNECT) {
+                    int r = i + k * dirs[d][0], c = j + k * dirs[d][1];
+                    if (r < 0 || r >= rows || c >= cols || board[r][c] != player) break;
+                    k++;
+                }
+                if (k == CONNECT) return true;
+            }
         }
     }
-
     return false;
 }
 
@@ -106,281 +81,54 @@ int getColumn(int maxCols) {
     }
 }
 
-void copyBoard(char dest[rows][cols], char src[rows][cols]) {
-    for (int i = 0; i < rows; i++)
-        for (int j = 0; j < cols; j++)
-            dest[i][j] = src[i][j];
-}
-
-void getValidLocations(char board[rows][cols], int valid[], int *validCount) {
-    *validCount = 0;
-    for (int j = 0; j < cols; j++) {
-        if (board[0][j] == '.') {
-            valid[(*validCount)++] = j;
-        }
-    }
-}
-
-bool isTerminalNode(char board[rows][cols], char bot, char player) {
-    return checkWin(board, bot) || checkWin(board, player) || boardFull(board);
-}
-
-int evaluateWindow(char window[4], char bot, char player) {
-    int score = 0;
-    int botCount = 0, playerCount = 0, emptyCount = 0;
-    for (int i = 0; i < 4; i++) {
-        if (window[i] == bot) botCount++;
-        else if (window[i] == player) playerCount++;
-        else emptyCount++;
-    }
-
-    if (botCount == 4) score += 10000;
-    else if (botCount == 3 && emptyCount == 1) score += 100;
-    else if (botCount == 2 && emptyCount == 2) score += 10;
-
-    if (playerCount == 3 && emptyCount == 1) score -= 900;
-    else if (playerCount == 2 && emptyCount == 2) score -= 20;
-
-    return score;
-}
-
-int scorePosition(char board[rows][cols], char bot, char player) {
-    int score = 0;
-
-    int centerCol = cols / 2;
-    int centerCount = 0;
-    for (int r = 0; r < rows; r++)
-        if (board[r][centerCol] == bot) centerCount++;
-    score += centerCount * 6;
-
-    for (int r = 0; r < rows; r++) {
-        for (int c = 0; c <= cols - 4; c++) {
-            char window[4];
-            for (int k = 0; k < 4; k++) window[k] = board[r][c + k];
-            score += evaluateWindow(window, bot, player);
-        }
-    }
-
-    for (int c = 0; c < cols; c++) {
-        for (int r = 0; r <= rows - 4; r++) {
-            char window[4];
-            for (int k = 0; k < 4; k++) window[k] = board[r + k][c];
-            score += evaluateWindow(window, bot, player);
-        }
-    }
-
-    for (int r = 3; r < rows; r++) {
-        for (int c = 0; c <= cols - 4; c++) {
-            char window[4];
-            for (int k = 0; k < 4; k++) window[k] = board[r - k][c + k];
-            score += evaluateWindow(window, bot, player);
-        }
-    }
-
-    for (int r = 0; r <= rows - 4; r++) {
-        for (int c = 0; c <= cols - 4; c++) {
-            char window[4];
-            for (int k = 0; k < 4; k++) window[k] = board[r + k][c + k];
-            score += evaluateWindow(window, bot, player);
-        }
-    }
-
-    return score;
-}
-
-int minimax(char board[rows][cols], int depth, int alpha, int beta, bool maximizingPlayer, char bot, char player, int *bestCol) {
-    int valid[cols];
-    int validCount;
-    getValidLocations(board, valid, &validCount);
-
-    bool isTerminal = isTerminalNode(board, bot, player);
-    if (depth == 0 || isTerminal) {
-        if (isTerminal) {
-            if (checkWin(board, bot)) return 100000000;
-            else if (checkWin(board, player)) return -100000000;
-            else return 0;
-        } else {
-            return scorePosition(board, bot, player);
-        }
-    }
-
-    if (maximizingPlayer) {
-        int value = INT_MIN;
-        int column = validCount > 0 ? valid[0] : -1;
-        for (int i = 0; i < validCount; i++) {
-            int col = valid[i];
-            char temp[rows][cols];
-            copyBoard(temp, board);
-            if (!update(temp, col, bot)) continue;
-            int newScore = minimax(temp, depth - 1, alpha, beta, false, bot, player, NULL);
-            if (newScore > value) { value = newScore; column = col; }
-            if (value > alpha) alpha = value;
-            if (alpha >= beta) break;
-        }
-        if (bestCol) *bestCol = column;
-        return value;
-    } else {
-        int value = INT_MAX;
-        int column = validCount > 0 ? valid[0] : -1;
-        for (int i = 0; i < validCount; i++) {
-            int col = valid[i];
-            char temp[rows][cols];
-            copyBoard(temp, board);
-            if (!update(temp, col, player)) continue;
-            int newScore = minimax(temp, depth - 1, alpha, beta, true, bot, player, NULL);
-            if (newScore < value) { value = newScore; column = col; }
-            if (value < beta) beta = value;
-            if (alpha >= beta) break;
-        }
-        if (bestCol) *bestCol = column;
-        return value;
-    }
-}
-
-typedef struct {
-    char board[rows][cols];
-    int col;
-    char bot;
-    char player;
-    int depth;
-    int score;
-    bool valid;
-} ThreadArg;
-
-void *worker_func(void *varg) {
-    ThreadArg *arg = (ThreadArg *)varg;
-    if (!arg->valid) {
-        arg->score = INT_MIN + 1;
-        return NULL;
-    }
-    int sc = minimax(arg->board, arg->depth, INT_MIN + 1, INT_MAX - 1, false, arg->bot, arg->player, NULL);
-    arg->score = sc;
-    return NULL;
+static ParallelSearch searcher;
+static Book openingBook;
+static Bot bot;
+static int moveBudgetMs = DEFAULT_MOVE_BUDGET_MS;
+
+/* Hard's search for bot.c: every thread of the searcher on one tree */
+static SearchResult parallelBotSearch(Bot *b, Position *pos, int budgetMs, BotChoice *why) {
+    ParallelSearch *ps = b->searchArg;
+    SearchResult result = parallelSearch(ps, pos, b->maxDepth, budgetMs);
+    why->nodes = ps->nodes;
+    why->threads = ps->threadCount;
+#ifdef SEARCH_STATS
+    why->stats = parallelStatsSum(ps);
+#endif
+    return result;
 }
 
-int botMove(char board[rows][cols], char bot, char player, int difficulty) {
-    int col;
-
-    if (difficulty == 1) {
-        do {
-            col = rand() % cols;
-        } while (board[0][col] != '.');
-        printf("Bot chooses column %d (Easy)\n", col + 1);
-        return col;
-    }
-
-    for (int j = 0; j < cols; j++) {
-        char temp[rows][cols];
-        copyBoard(temp, board);
-        if (update(temp, j, bot) && checkWin(temp, bot)) {
-            printf("Bot chooses column %d (Winning Move)\n", j + 1);
-            return j;
-        }
-    }
-
-    for (int j = 0; j < cols; j++) {
-        char temp[rows][cols];
-        copyBoard(temp, board);
-        if (update(temp, j, player) && checkWin(temp, player)) {
-            printf("Bot chooses column %d (Blocking Move)\n", j + 1);
-            return j;
-        }
-    }
-
-    if (difficulty == 2) {
-        if (board[0][cols / 2] == '.') {
-            printf("Bot chooses column %d (Center Preference)\n", cols / 2 + 1);
-            return cols / 2;
-        }
-
-        int offsets[] = {0, 1, -1, 2, -2, 3, -3};
-        for (int k = 0; k < 7; k++) {
-            int c = cols / 2 + offsets[k];
-            if (c >= 0 && c < cols && board[0][c] == '.') {
-                printf("Bot chooses column %d (Strategic Fallback)\n", c + 1);
-                return c;
-            }
-        }
-
-        do {
-            col = rand() % cols;
-        } while (board[0][col] != '.');
-        printf("Bot chooses column %d (Random Fallback)\n", col + 1);
-        return col;
-    }
-
-    if (difficulty == 3) {
-        int fullDepth = 6;
-        int searchDepth = fullDepth;
-        int validCols[cols];
-        int validCount = 0;
-        for (int j = 0; j < cols; j++) if (board[0][j] == '.') validCols[validCount++] = j;
-
-        if (validCount == 0) {
-            return rand() % cols;
-        }
-
-        pthread_t threads[cols];
-        ThreadArg args[cols];
-        int threadCount = validCount;
-
-        for (int i = 0; i < threadCount; i++) {
-            int c = validCols[i];
-            copyBoard(args[i].board, board);
-            args[i].col = c;
-            args[i].bot = bot;
-            args[i].player = player;
-            args[i].valid = update(args[i].board, c, bot);
-            args[i].depth = (searchDepth > 0) ? (searchDepth - 1) : 0;
-            args[i].score = INT_MIN + 1;
-            pthread_create(&threads[i], NULL, worker_func, &args[i]);
-        }
-
-        for (int i = 0; i < threadCount; i++) {
-            pthread_join(threads[i], NULL);
-        }
-
-        int bestIndex = -1;
-        int bestScore = INT_MIN;
-        for (int i = 0; i < threadCount; i++) {
-            if (!args[i].valid) continue;
-            if (args[i].score > bestScore) {
-                bestScore = args[i].score;
-                bestIndex = i;
-            }
-        }
-
-        int chosen;
-        if (bestIndex >= 0) chosen = args[bestIndex].col;
-        else {
-            if (board[0][cols / 2] == '.') chosen = cols / 2;
-            else {
-                int offsets[] = {0, 1, -1, 2, -2, 3, -3};
-                int found = -1;
-                for (int k = 0; k < 7; k++) {
-                    int c = cols / 2 + offsets[k];
-                    if (c >= 0 && c < cols && board[0][c] == '.') { found = c; break; }
-                }
-                if (found >= 0) chosen = found;
-                else {
-                    do { chosen = rand() % cols; } while (board[0][chosen] != '.');
-                }
-            }
-        }
-
-        printf("Bot chooses column %d (Hard, parallel root search)\n", chosen + 1);
-        return chosen;
-    }
-
-    do {
-        col = rand() % cols;
-    } while (board[0][col] != '.');
-    printf("Bot chooses column %d (Fallback)\n", col + 1);
+int botMove(char board[rows][cols], char symbol) {
+    BotChoice why;
+    int col = botChoose(&bot, board, symbol, &why);
+    botPrintChoice(&why);
+#ifdef SEARCH_STATS
+    if (why.reason == CHOICE_HARD) parallelStatsPrint(&searcher);
+#endif
     return col;
 }
 
-int main() {
+int main(int argc, char **argv) {
     srand((unsigned int)time(NULL));
+    engineInit();
+
+    /* multithreaded [ms] [lazy] [--threads N] [--pin] */
+    int parallelMode = PARALLEL_YBWC;
+    int threads = parallelDefaultThreads();
+    bool pin = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "lazy") == 0) parallelMode = PARALLEL_LAZY_SMP;
+        else if (strcmp(argv[i], "--pin") == 0) pin = true;
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else moveBudgetMs = atoi(argv[i]);
+    }
+    if (moveBudgetMs <= 0) moveBudgetMs = DEFAULT_MOVE_BUDGET_MS;
+    if (threads <= 0) threads = parallelDefaultThreads();
+    if (!parallelInit(&searcher, threads, parallelMode, pin)) {
+        printf("Could not start the bot's search threads.\n");
+        return 1;
+    }
+    bookOpen(&openingBook, BOOK_DEFAULT_PATH);
     char A, B;
     int mode, difficulty = 0;
 
@@ -397,12 +145,26 @@ int main() {
     } else {
         B = 'O';
         printf("Bot symbol is '%c'\n", B);
-        printf("Choose difficulty:\n1. Easy\n2. Medium\n3. Hard\n> ");
+        printf("Choose difficulty:\n1. Easy\n2. Medium\n3. Hard\n4. Perfect\n> ");
         scanf("%d", &difficulty);
         printf("You selected ");
         if (difficulty == 1) printf("Easy\n");
         else if (difficulty == 2) printf("Medium\n");
+        else if (difficulty == 4) printf("Perfect\n");
         else printf("Hard\n");
+        if (difficulty < BOT_EASY || difficulty > BOT_PERFECT) difficulty = BOT_HARD;
+
+        unsigned seed = (unsigned)time(NULL);
+        bool ready = botInitSearch(&bot, difficulty, &openingBook, seed, parallelBotSearch, &searcher);
+        if (!ready && difficulty == BOT_PERFECT) {
+            printf("Not enough memory for the solver, playing Hard instead.\n");
+            ready = botInitSearch(&bot, BOT_HARD, &openingBook, seed, parallelBotSearch, &searcher);
+        }
+        if (!ready) {
+            printf("Out of memory.\n");
+            return 1;
+        }
+        bot.budgetMs = moveBudgetMs;
     }
 
     char player = A;
@@ -414,7 +176,7 @@ int main() {
         int col;
 
         if (mode == 2 && player == B) {
-            col = botMove(board, B, A, difficulty);
+            col = botMove(board, B);
         } else {
             printf("Player %c, enter column (1-%d): ", player, cols);
             fflush(stdout);
@@ -445,4 +207,4 @@ int main() {
     }
 
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
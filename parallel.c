@@ -0,0 +1,248 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "parallel.h"
+
+int parallelDefaultThreads(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+    if (n > MAX_SEARCH_THREADS) n = MAX_SEARCH_THREADS;
+    return (int)n;
+}
+
+/* ---------- Split points ---------- */
+
+static bool isInside(const SplitPoint *sp, const SplitPoint *ancestor) {
+    for (; sp; sp = sp->parent)
+        if (sp == ancestor) return true;
+    return false;
+}
+
+/* the open split point with the most work left; an owner waiting for its
+ * helpers only takes work below its own split point so it is back in time */
+static SplitPoint *findWork(ParallelSearch *ps, const SplitPoint *below) {
+    SplitPoint *best = NULL;
+    if (atomic_load_explicit(&ps->stop, memory_order_relaxed)) return NULL;
+    for (SplitPoint *sp = ps->open; sp; sp = sp->nextOpen) {
+        if (sp->next >= sp->count || atomic_load_explicit(&sp->cutoff, memory_order_relaxed)) continue;
+        if (below && !isInside(sp, below)) continue;
+        if (!best || sp->depth > best->depth) best = sp;
+    }
+    return best;
+}
+
+static void removeOpen(ParallelSearch *ps, SplitPoint *sp) {
+    for (SplitPoint **link = &ps->open; *link; link = &(*link)->nextOpen) {
+        if (*link == sp) {
+            *link = sp->nextOpen;
+            return;
+        }
+    }
+}
+
+/* Takes moves of sp until none are left; called and returns with the lock
+ * held. Each move is searched against the best alpha any thread has found
+ * so far, and a cutoff stops everyone below sp. */
+static void helpAt(SearchWorker *w, SplitPoint *sp) {
+    ParallelSearch *ps = w->ps;
+    SearchContext *ctx = &w->ctx;
+    SplitPoint *saved = w->active;
+    Position pos = sp->pos;
+
+    sp->workers++;
+    w->active = sp;
+    ctx->botColour = sp->botColour;
+    ctx->deadline = sp->deadline;
+    ctx->followPv = false;
+    while (sp->next < sp->count && !atomic_load_explicit(&sp->cutoff, memory_order_relaxed)) {
+        int col = sp->moves[sp->next++];
+        int alpha = sp->alpha;
+        STAT(ctx->stats.splitMoves++;)
+        pthread_mutex_unlock(&ps->lock);
+        int score = searchSibling(ctx, &pos, col, sp->depth, alpha, sp->beta);
+        pthread_mutex_lock(&ps->lock);
+        if (searchStopped(ctx)) break;
+        if (score > sp->value) { sp->value = score; sp->column = col; }
+        if (score > sp->alpha) sp->alpha = score;
+        if (sp->alpha >= sp->beta) atomic_store_explicit(&sp->cutoff, true, memory_order_relaxed);
+    }
+    w->active = saved;
+    if (--sp->workers == 0) pthread_cond_broadcast(&ps->wake);
+}
+
+/* SearchContext.split: opens a split point when some helper is idle */
+static bool splitNode(SearchContext *ctx, Position *pos, int depth, int alpha, int beta,
+                      const int *moves, int count, int *value, int *column) {
+    SearchWorker *w = ctx->worker;
+    ParallelSearch *ps = w->ps;
+    if (depth < SPLIT_MIN_DEPTH || atomic_load_explicit(&ps->idle, memory_order_relaxed) == 0) return false;
+
+    SplitPoint sp = {
+        .parent = w->active, .pos = *pos, .depth = depth, .beta = beta,
+        .botColour = ctx->botColour, .deadline = ctx->deadline, .count = count,
+        .alpha = alpha, .value = *value, .column = *column,
+    };
+    for (int i = 0; i < count; i++) sp.moves[i] = moves[i];
+    atomic_init(&sp.cutoff, false);
+
+    pthread_mutex_lock(&ps->lock);
+    sp.nextOpen = ps->open;
+    ps->open = &sp;
+    ps->splits++;
+    pthread_cond_broadcast(&ps->wake);
+
+    helpAt(w, &sp);
+    removeOpen(ps, &sp);
+    /* helpers still search moves of sp on their own copies of the position */
+    while (sp.workers > 0) {
+        SplitPoint *work = findWork(ps, &sp);
+        if (work) helpAt(w, work);
+        else pthread_cond_wait(&ps->wake, &ps->lock);
+    }
+    *value = sp.value;
+    *column = sp.column;
+    pthread_mutex_unlock(&ps->lock);
+    return true;
+}
+
+/* SearchContext.aborted: a cutoff anywhere above makes this subtree moot */
+static bool cutoffAbove(SearchContext *ctx) {
+    SearchWorker *w = ctx->worker;
+    for (SplitPoint *sp = w->active; sp; sp = sp->parent)
+        if (atomic_load_explicit(&sp->cutoff, memory_order_relaxed)) return true;
+    return false;
+}
+
+/* ---------- Threads ---------- */
+
+static void helperMain(void *arg) {
+    SearchWorker *w = arg;
+    ParallelSearch *ps = w->ps;
+    pthread_mutex_lock(&ps->lock);
+    while (!ps->quit) {
+        SplitPoint *sp = findWork(ps, NULL);
+        if (sp) {
+            helpAt(w, sp);
+            continue;
+        }
+        atomic_fetch_add(&ps->idle, 1);
+        pthread_cond_wait(&ps->wake, &ps->lock);
+        atomic_fetch_sub(&ps->idle, 1);
+    }
+    pthread_mutex_unlock(&ps->lock);
+}
+
+/* a Lazy SMP helper: its own iterative deepening, whose only output is
+ * what it leaves in the shared table for the main thread to find. Its
+ * deadline sets helperStop, so it never cuts the main thread's depth 1 short. */
+static void lazyHelperMain(void *arg) {
+    SearchWorker *w = arg;
+    ParallelSearch *ps = w->ps;
+    SearchContext *ctx = &w->ctx;
+    Position pos = ps->root;
+
+    ctx->botColour = pos.moves & 1;
+    ctx->deadline = ps->deadline;
+    ctx->followPv = false;
+    for (int depth = 1 + w->index % 2; depth <= ps->maxDepth; depth++) {
+        int col;
+        negamax(ctx, &pos, depth, INT_MIN + 1, INT_MAX - 1, &col);
+        if (searchStopped(ctx)) break;
+    }
+}
+
+bool parallelInit(ParallelSearch *ps, int threads, int mode, bool pin) {
+    if (threads < 1) threads = 1;
+    if (threads > MAX_SEARCH_THREADS) threads = MAX_SEARCH_THREADS;
+    *ps = (ParallelSearch){ .mode = mode };
+    if (!ttInit(&ps->tt, SHARED_TT_BITS)) return false;
+    ps->workers = calloc(threads, sizeof(SearchWorker));
+    /* the calling thread is workers[0]; the pool runs the helpers, on
+     * CPUs 1, 2, ... when pinned */
+    if (!ps->workers || !poolInit(&ps->pool, threads - 1, pin ? 1 : -1)) {
+        free(ps->workers);
+        ttFree(&ps->tt);
+        return false;
+    }
+    ps->threadCount = threads;
+    for (int i = 0; i < threads; i++) {
+        SearchWorker *w = &ps->workers[i];
+        w->ps = ps;
+        w->index = i;
+        searchInit(&w->ctx, &ps->tt);
+        w->ctx.stop = (mode == PARALLEL_LAZY_SMP && i > 0) ? &ps->helperStop : &ps->stop;
+        w->ctx.worker = w;
+        if (mode == PARALLEL_YBWC) {
+            w->ctx.split = splitNode;
+            w->ctx.aborted = cutoffAbove;
+        }
+    }
+    pthread_mutex_init(&ps->lock, NULL);
+    pthread_cond_init(&ps->wake, NULL);
+    return true;
+}
+
+void parallelFree(ParallelSearch *ps) {
+    if (!ps->workers) return;
+    poolFree(&ps->pool);
+    ttFree(&ps->tt);
+    free(ps->workers);
+    ps->workers = NULL;
+    pthread_mutex_destroy(&ps->lock);
+    pthread_cond_destroy(&ps->wake);
+}
+
+SearchResult parallelSearch(ParallelSearch *ps, Position *pos, int maxDepth, int budgetMs) {
+    int remaining = rows * cols - pos->moves;
+    atomic_store(&ps->stop, false);
+    atomic_store(&ps->helperStop, false);
+    atomic_store(&ps->idle, 0);
+    ps->quit = false;
+    ps->open = NULL;
+    ps->splits = 0;
+    ps->root = *pos;
+    ps->maxDepth = maxDepth < remaining ? maxDepth : remaining;
+    ps->deadline = deadlineAfterMs(budgetMs);
+    for (int i = 0; i < ps->threadCount; i++) {
+        ps->workers[i].ctx.nodes = 0;
+        STAT(ps->workers[i].ctx.stats = (SearchStats){ 0 };)
+    }
+
+    PoolJobFn helper = ps->mode == PARALLEL_LAZY_SMP ? lazyHelperMain : helperMain;
+    for (int i = 1; i < ps->threadCount; i++) poolSubmit(&ps->pool, helper, &ps->workers[i]);
+
+    SearchResult result = iterativeDeepening(&ps->workers[0].ctx, pos, maxDepth, budgetMs);
+
+    atomic_store(&ps->stop, true);
+    atomic_store(&ps->helperStop, true);
+    pthread_mutex_lock(&ps->lock);
+    ps->quit = true;
+    pthread_cond_broadcast(&ps->wake);
+    pthread_mutex_unlock(&ps->lock);
+    poolWait(&ps->pool);
+
+    ps->nodes = 0;
+    for (int i = 0; i < ps->threadCount; i++) ps->nodes += ps->workers[i].ctx.nodes;
+    return result;
+}
+
+#ifdef SEARCH_STATS
+/* the last search over all threads */
+SearchStats parallelStatsSum(const ParallelSearch *ps) {
+    SearchStats sum = ps->workers[0].ctx.stats;
+    for (int i = 1; i < ps->threadCount; i++) searchStatsAdd(&sum, &ps->workers[i].ctx.stats);
+    return sum;
+}
+
+/* the split points and each thread's share of the last search */
+void parallelStatsPrint(const ParallelSearch *ps) {
+    printf("  %lld split points\n", ps->splits);
+    for (int i = 0; i < ps->threadCount; i++) {
+        const SearchContext *ctx = &ps->workers[i].ctx;
+        printf("  thread %2d: %11lld nodes (%5.1f%%), %lld split moves\n", i, ctx->nodes,
+               ps->nodes > 0 ? 100.0 * ctx->nodes / ps->nodes : 0.0, ctx->stats.splitMoves);
+    }
+}
+#endif
@@ -0,0 +1,93 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "engine.h"
+#include "threadpool.h"
+
+#define MAX_SEARCH_THREADS 64
+#define SHARED_TT_BITS 22
+
+enum {
+    /* Young Brothers Wait: a node is only shared once its first move has
+     * been searched alone, so the other moves start from a real alpha */
+    PARALLEL_YBWC,
+    /* Lazy SMP: every thread searches the whole tree on its own, helpers
+     * one ply deeper on every other thread, and they only meet in the
+     * shared table */
+    PARALLEL_LAZY_SMP
+};
+
+#define SPLIT_MIN_DEPTH 4           /* smaller subtrees are not worth a split */
+
+typedef struct SplitPoint SplitPoint;
+
+/* A node whose remaining moves any thread may take. It lives on the stack
+ * of the thread that opened it, which waits until every helper has left.
+ * All fields but cutoff are guarded by the pool lock. */
+struct SplitPoint {
+    SplitPoint *parent;         /* split point the owner was working in, NULL at the top */
+    SplitPoint *nextOpen;       /* list of split points helpers can still join */
+    Position pos;
+    int depth;
+    int beta;
+    int botColour;
+    long long deadline;
+    int moves[cols];
+    int count;
+    int next;                   /* moves[next] is the next one to hand out */
+    int alpha;                  /* best score so far, raised by every thread */
+    int value;
+    int column;
+    int workers;                /* threads searching one of its moves, owner included */
+    atomic_bool cutoff;         /* some move reached beta, the others are wasted */
+};
+
+typedef struct ParallelSearch ParallelSearch;
+
+typedef struct {
+    ParallelSearch *ps;
+    int index;
+    SearchContext ctx;
+    SplitPoint *active;         /* innermost split point this thread works in */
+} SearchWorker;
+
+struct ParallelSearch {
+    SearchWorker *workers;      /* workers[0] is the thread that calls parallelSearch */
+    int threadCount;
+    ThreadPool pool;            /* threadCount - 1 helpers, kept between searches */
+    int mode;                   /* PARALLEL_YBWC or PARALLEL_LAZY_SMP */
+    TranspositionTable tt;      /* shared by every thread */
+
+    /* the search under way, for Lazy SMP helpers */
+    Position root;
+    int maxDepth;
+    long long deadline;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        /* a split point opened, a helper left one, or quit */
+    SplitPoint *open;
+    atomic_int idle;            /* helpers waiting for work */
+    atomic_bool stop;
+    atomic_bool helperStop;     /* Lazy SMP helpers': their deadline must not stop the main thread */
+    bool quit;
+    long long nodes;            /* all threads, last search */
+    long long splits;           /* last search */
+};
+
+int parallelDefaultThreads(void);
+/* pin puts the helper threads on a CPU each */
+bool parallelInit(ParallelSearch *ps, int threads, int mode, bool pin);
+void parallelFree(ParallelSearch *ps);
+
+/* iterativeDeepening with every thread of ps on the same tree */
+SearchResult parallelSearch(ParallelSearch *ps, Position *pos, int maxDepth, int budgetMs);
+
+#ifdef SEARCH_STATS
+SearchStats parallelStatsSum(const ParallelSearch *ps);
+void parallelStatsPrint(const ParallelSearch *ps);
+#endif
+
+#endif
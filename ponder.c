@@ -0,0 +1,81 @@
+#include "ponder.h"
+
+#define PONDER_MAX_MS (1 << 24)
+
+/* every pass gives each reply twice the time of the pass before, so the
+ * longer the opponent thinks the deeper every answer gets */
+static void *ponderMain(void *arg) {
+    Ponder *p = arg;
+    for (int budget = p->budgetMs; ; budget = budget < PONDER_MAX_MS ? budget * 2 : budget) {
+        bool open = false;
+        for (int i = 0; i < p->count; i++) {
+            int col = p->order[i];
+            Position next = p->pos;
+            playMove(&next, col);
+
+            atomic_store(&p->searchStop, false);
+            if (atomic_load(&p->quit)) return NULL;
+            SearchContext ctx;
+            searchInit(&ctx, p->tt);
+            ctx.stop = &p->searchStop;
+            SearchResult r = iterativeDeepening(&ctx, &next, MAX_DEPTH, budget);
+            if (atomic_load(&p->quit)) return NULL;
+            if (r.bestCol < 0) continue;
+
+            p->results[col] = r;
+            p->nodes[col] = ctx.nodes;
+            p->done[col] = true;
+            if (r.score < WIN_SCORE && r.score > -WIN_SCORE && r.depth < rows * cols - next.moves) open = true;
+        }
+        /* every answer is already a proven result */
+        if (!open) break;
+    }
+    return NULL;
+}
+
+bool ponderStart(Ponder *p, TranspositionTable *tt, const Position *pos, int budgetMs) {
+    p->tt = tt;
+    p->pos = *pos;
+    p->budgetMs = budgetMs;
+    p->count = 0;
+    p->running = false;
+    atomic_store(&p->quit, false);
+    atomic_store(&p->searchStop, false);
+
+    /* the bot's own search stored the reply it expects in the table */
+    int expected = -1;
+    TTEntry e;
+    if (ttProbe(tt, pos->hash, &e) && canPlay(pos, e.bestCol)) expected = e.bestCol;
+
+    for (int k = -1; k < cols; k++) {
+        int col = k < 0 ? expected : centerOrder[k];
+        if (col < 0 || (k >= 0 && col == expected) || !canPlay(pos, col)) continue;
+        p->done[col] = false;
+        /* a reply that ends the game leaves the bot nothing to answer */
+        if (isWinningMove(pos, col) || pos->moves + 1 == rows * cols) continue;
+        p->order[p->count++] = col;
+    }
+    if (p->count == 0) return false;
+    p->running = pthread_create(&p->thread, NULL, ponderMain, p) == 0;
+    return p->running;
+}
+
+int ponderStop(Ponder *p, const Position *pos, SearchResult *result, long long *nodes) {
+    if (!p->running) return -1;
+    atomic_store(&p->quit, true);
+    atomic_store(&p->searchStop, true);
+    pthread_join(p->thread, NULL);
+    p->running = false;
+    if (!pos) return -1;
+
+    for (int i = 0; i < p->count; i++) {
+        int col = p->order[i];
+        Position next = p->pos;
+        playMove(&next, col);
+        if (!p->done[col] || next.mask != pos->mask || next.current != pos->current) continue;
+        if (result) *result = p->results[col];
+        if (nodes) *nodes = p->nodes[col];
+        return p->results[col].bestCol;
+    }
+    return -1;
+}
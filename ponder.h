@@ -0,0 +1,40 @@
+#ifndef PONDER_H
+#define PONDER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "engine.h"
+
+/* Searching on the opponent's time: after the bot moves, a background
+ * thread searches the bot's answer to each reply the opponent could make,
+ * the expected one first, with the normal move budget. Everything lands
+ * in the shared table, so even an interrupted search speeds up the real
+ * one; a reply whose search already ran its whole budget is answered at
+ * once. */
+typedef struct {
+    TranspositionTable *tt;
+    Position pos;               /* the opponent is to move */
+    int budgetMs;
+    int order[cols];            /* replies to search, most likely first */
+    int count;
+    SearchResult results[cols]; /* per reply column, from a search that ran its whole budget */
+    long long nodes[cols];      /* behind results */
+    bool done[cols];
+    atomic_bool quit;
+    atomic_bool searchStop;     /* stop flag of the search under way */
+    pthread_t thread;
+    bool running;
+} Ponder;
+
+/* starts pondering on pos, where the opponent is to move; the table must
+ * not be used by anyone else until ponderStop */
+bool ponderStart(Ponder *p, TranspositionTable *tt, const Position *pos, int budgetMs);
+
+/* Stops pondering and waits for the thread. Returns the pondered best
+ * column if pos, with the bot to move, is one of the finished replies,
+ * otherwise -1; *result and *nodes get the search behind it (either may
+ * be NULL). pos may be NULL when the game is over. */
+int ponderStop(Ponder *p, const Position *pos, SearchResult *result, long long *nodes);
+
+#endif
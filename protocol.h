@@ -0,0 +1,82 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* ---------- Compact protocol ----------
+ * The legacy protocol sends the mode int once, then the whole board, the
+ * status and yourTurn after every move, twice a round. The compact one
+ * sends the board only when a game starts or a client asks to resync;
+ * a move is a 10-byte message. Every message is one length byte (what
+ * follows it), a type byte and the payload, integers big-endian:
+ *
+ *   client HELLO   version
+ *   server BOARD   version, mode, game id (4), ply, status, yourTurn, board (rows * cols)
+ *   server MOVE    game id (4), ply, column, status, yourTurn
+ *   client PLAY    ply, column
+ *   client RESYNC  (nothing)
+ *
+ * ply is the number of stones on the board before the move, so a PLAY
+ * for a board the client no longer has is answered with a BOARD instead.
+ * status is the legacy one: 0 playing, 1 server wins, 2 client wins, 3
+ * draw. A server that does not speak the client's version closes. */
+
+#define PROTOCOL_VERSION 1
+#define MSG_MAX 255
+
+enum { MSG_HELLO = 1, MSG_BOARD, MSG_MOVE, MSG_PLAY, MSG_RESYNC };
+
+#define MSG_HELLO_SIZE 3
+#define MSG_BOARD_SIZE (11 + rows * cols)
+#define MSG_MOVE_SIZE 10
+#define MSG_PLAY_SIZE 4
+#define MSG_RESYNC_SIZE 2
+
+static inline void putU32(unsigned char *p, uint32_t x) {
+    p[0] = x >> 24; p[1] = x >> 16; p[2] = x >> 8; p[3] = x;
+}
+
+static inline uint32_t getU32(const unsigned char *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+/* each returns the message size */
+static inline int msgHello(unsigned char *p) {
+    p[0] = MSG_HELLO_SIZE - 1; p[1] = MSG_HELLO; p[2] = PROTOCOL_VERSION;
+    return MSG_HELLO_SIZE;
+}
+
+static inline int msgBoard(unsigned char *p, int mode, uint32_t gameId, int ply, int status, bool yourTurn,
+                           char board[rows][cols]) {
+    p[0] = MSG_BOARD_SIZE - 1; p[1] = MSG_BOARD; p[2] = PROTOCOL_VERSION; p[3] = mode;
+    putU32(p + 4, gameId);
+    p[8] = ply; p[9] = status; p[10] = yourTurn;
+    memcpy(p + 11, board, rows * cols);
+    return MSG_BOARD_SIZE;
+}
+
+static inline int msgMove(unsigned char *p, uint32_t gameId, int ply, int col, int status, bool yourTurn) {
+    p[0] = MSG_MOVE_SIZE - 1; p[1] = MSG_MOVE;
+    putU32(p + 2, gameId);
+    p[6] = ply; p[7] = col; p[8] = status; p[9] = yourTurn;
+    return MSG_MOVE_SIZE;
+}
+
+static inline int msgPlay(unsigned char *p, int ply, int col) {
+    p[0] = MSG_PLAY_SIZE - 1; p[1] = MSG_PLAY; p[2] = ply; p[3] = col;
+    return MSG_PLAY_SIZE;
+}
+
+static inline int msgResync(unsigned char *p) {
+    p[0] = MSG_RESYNC_SIZE - 1; p[1] = MSG_RESYNC;
+    return MSG_RESYNC_SIZE;
+}
+
+/* size of the first message in buf[0 .. len - 1], 0 if it is not all there */
+static inline int msgComplete(const unsigned char *buf, int len) {
+    return (len >= 1 && len >= 1 + buf[0]) ? 1 + buf[0] : 0;
+}
+
+#endif
@@ -0,0 +1,258 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+#include "parallel.h"
+
+/* Runs every search configuration on a fixed set of positions and reports
+ * nodes, speed, time to each depth, branching factor and the move chosen;
+ * --json prints the same as one JSON document for tracking regressions.
+ * Each depth is an iterative deepening run of its own from an empty table,
+ * so time-to-depth is what a real search to that depth costs and the
+ * numbers do not depend on the order things ran in.
+ * Usage: searchbench [positions=bench/search_positions.txt] [--json]
+ *                    [--depth N] [--threads N] [--config name] */
+
+#define BENCH_DEFAULT_PATH "bench/search_positions.txt"
+#define BENCH_MAX_POSITIONS 256
+#define BENCH_BUDGET_MS (1 << 30)   /* depth-limited, never by time */
+
+enum { CONFIG_MINIMAX, CONFIG_PVS, CONFIG_PVS_BATCH, CONFIG_YBWC, CONFIG_LAZY_SMP, CONFIG_COUNT };
+
+static const char *configNames[CONFIG_COUNT] = { "minimax", "pvs", "pvs-batch", "ybwc", "lazy-smp" };
+
+typedef struct {
+    char category[16];
+    char moves[64];
+    int depth;
+    Position pos;
+} BenchPosition;
+
+typedef struct {
+    int depth;                      /* last run, less than asked once the result was forced */
+    int bestCol;
+    int score;
+    int threads;                    /* that searched, 1 for the single-threaded configurations */
+    long long nodes[MAX_DEPTH + 1]; /* per run to that depth */
+    long long ns[MAX_DEPTH + 1];
+} BenchRun;
+
+/* lines of "<category> <moves> <depth>"; returns the count, -1 if the
+ * file cannot be read */
+static int loadPositions(const char *path, BenchPosition *out, int max) {
+    FILE *in = fopen(path, "r");
+    if (!in) return -1;
+    char line[256];
+    int count = 0;
+    while (count < max && fgets(line, sizeof(line), in)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        BenchPosition *b = &out[count];
+        if (sscanf(line, "%15s %63s %d", b->category, b->moves, &b->depth) != 3) continue;
+        positionInit(&b->pos);
+        bool ok = true;
+        for (const char *m = b->moves; *m && *m != '-' && ok; m++) {
+            int col = *m - '1';
+            ok = canPlay(&b->pos, col) && !isWinningMove(&b->pos, col);
+            if (ok) playMove(&b->pos, col);
+        }
+        if (!ok || b->depth < 1) {
+            printf("skipping invalid line: %s", line);
+            continue;
+        }
+        count++;
+    }
+    fclose(in);
+    return count;
+}
+
+/* one iterative deepening run to depth; the caller clears the table */
+static SearchResult searchTo(int config, TranspositionTable *tt, ParallelSearch *ps, Position *pos, int depth, long long *nodes) {
+    if (ps) {
+        SearchResult r = parallelSearch(ps, pos, depth, BENCH_BUDGET_MS);
+        *nodes = ps->nodes;
+        return r;
+    }
+    SearchContext ctx;
+    searchInit(&ctx, tt);
+    ctx.mode = config == CONFIG_MINIMAX ? SEARCH_MINIMAX : SEARCH_PVS;
+    ctx.batchLeaves = config == CONFIG_PVS_BATCH;
+    SearchResult r = iterativeDeepening(&ctx, pos, depth, BENCH_BUDGET_MS);
+    *nodes = ctx.nodes;
+    return r;
+}
+
+static void runPosition(int config, TranspositionTable *tt, ParallelSearch *ps, const BenchPosition *b, int depth, BenchRun *run) {
+    run->depth = 0;
+    run->bestCol = -1;
+    run->score = 0;
+    run->threads = ps ? ps->threadCount : 1;
+    for (int d = 1; d <= depth; d++) {
+        Position pos = b->pos;
+        long long nodes;
+        ttClear(ps ? &ps->tt : tt);
+        long long start = monotonicNs();
+        SearchResult r = searchTo(config, tt, ps, &pos, d, &nodes);
+        long long ns = monotonicNs() - start;
+        run->depth = d;
+        run->bestCol = r.bestCol;
+        run->score = r.score;
+        run->nodes[d] = nodes;
+        run->ns[d] = ns;
+        /* a forced result or the end of the board: deeper runs repeat this one */
+        if (r.depth < d || r.score >= WIN_SCORE || r.score <= -WIN_SCORE) break;
+    }
+}
+
+/* nodes per extra ply at the last depth, over two plies since the
+ * heuristic alternates between odd and even depths */
+static double branching(const BenchRun *run) {
+    int d = run->depth;
+    if (d < 3 || run->nodes[d - 2] == 0) return 0;
+    return sqrt((double)run->nodes[d] / run->nodes[d - 2]);
+}
+
+static double knps(long long nodes, long long ns) {
+    return ns > 0 ? nodes / (ns / 1e9) / 1000 : 0.0;
+}
+
+/* nodes and time at the deepest depth, summed over the positions */
+static void configTotals(const BenchRun *runs, int count, long long *nodes, long long *ns) {
+    *nodes = *ns = 0;
+    for (int i = 0; i < count; i++) {
+        if (!runs[i].depth) continue;
+        *nodes += runs[i].nodes[runs[i].depth];
+        *ns += runs[i].ns[runs[i].depth];
+    }
+}
+
+static int configThreads(const BenchRun *runs, int count) {
+    return count > 0 ? runs[0].threads : 1;
+}
+
+/* a forced-win or forced-loss line the search did not prove at its depth */
+static bool unproven(const BenchPosition *b, const BenchRun *run) {
+    if (strcmp(b->category, "forced-win") == 0) return run->score < WIN_SCORE;
+    if (strcmp(b->category, "forced-loss") == 0) return run->score > -WIN_SCORE;
+    return false;
+}
+
+int main(int argc, char **argv) {
+    const char *path = BENCH_DEFAULT_PATH;
+    bool json = false;
+    int depthOverride = 0, threads = parallelDefaultThreads(), only = -1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) json = true;
+        else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) depthOverride = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            for (int c = 0; c < CONFIG_COUNT; c++)
+                if (strcmp(configNames[c], name) == 0) only = c;
+            if (only < 0) {
+                printf("Unknown configuration '%s'.\n", name);
+                return 1;
+            }
+        } else path = argv[i];
+    }
+
+    engineInit();
+    static BenchPosition positions[BENCH_MAX_POSITIONS];
+    int count = loadPositions(path, positions, BENCH_MAX_POSITIONS);
+    if (count < 0) {
+        printf("Cannot read %s.\n", path);
+        return 1;
+    }
+    TranspositionTable tt;
+    BenchRun *runs = malloc((size_t)CONFIG_COUNT * (count > 0 ? count : 1) * sizeof(BenchRun));
+    if (!runs || !ttInit(&tt, TT_DEFAULT_BITS)) {
+        printf("Not enough memory for the benchmark.\n");
+        return 1;
+    }
+
+    for (int c = 0; c < CONFIG_COUNT; c++) {
+        if (only >= 0 && c != only) continue;
+        ParallelSearch ps;
+        bool parallel = c == CONFIG_YBWC || c == CONFIG_LAZY_SMP;
+        if (parallel && !parallelInit(&ps, threads, c == CONFIG_YBWC ? PARALLEL_YBWC : PARALLEL_LAZY_SMP, false)) {
+            printf("Could not start the search threads.\n");
+            return 1;
+        }
+        for (int i = 0; i < count; i++) {
+            int depth = depthOverride > 0 ? depthOverride : positions[i].depth;
+            runPosition(c, &tt, parallel ? &ps : NULL, &positions[i], depth, &runs[c * count + i]);
+        }
+        if (parallel) parallelFree(&ps);
+    }
+
+    if (json) {
+        printf("{\n  \"positions\": \"%s\",\n  \"threads\": %d,\n  \"runs\": [", path, threads);
+        bool first = true;
+        for (int c = 0; c < CONFIG_COUNT; c++) {
+            if (only >= 0 && c != only) continue;
+            for (int i = 0; i < count; i++) {
+                const BenchRun *run = &runs[c * count + i];
+                int d = run->depth;
+                printf("%s\n    {\"config\": \"%s\", \"category\": \"%s\", \"moves\": \"%s\", \"depth\": %d, "
+                       "\"threads\": %d, \"move\": %d, \"score\": %d, \"nodes\": %lld, \"ms\": %.3f, \"knps\": %.1f, "
+                       "\"branching\": %.3f, \"msToDepth\": [",
+                       first ? "" : ",", configNames[c], positions[i].category, positions[i].moves, d,
+                       run->threads, run->bestCol + 1, run->score, d ? run->nodes[d] : 0, d ? run->ns[d] / 1e6 : 0.0,
+                       d ? knps(run->nodes[d], run->ns[d]) : 0.0, branching(run));
+                for (int k = 1; k <= d; k++) printf("%s%.3f", k > 1 ? ", " : "", run->ns[k] / 1e6);
+                printf("]}");
+                first = false;
+            }
+        }
+        printf("\n  ],\n  \"totals\": [");
+        first = true;
+        for (int c = 0; c < CONFIG_COUNT; c++) {
+            if (only >= 0 && c != only) continue;
+            long long nodes, ns;
+            configTotals(runs + c * count, count, &nodes, &ns);
+            printf("%s\n    {\"config\": \"%s\", \"threads\": %d, \"nodes\": %lld, \"ms\": %.3f, \"knps\": %.1f}",
+                   first ? "" : ",", configNames[c], configThreads(runs + c * count, count), nodes, ns / 1e6,
+                   knps(nodes, ns));
+            first = false;
+        }
+        printf("\n  ]\n}\n");
+    } else {
+        printf("%-10s %-28s %-9s %7s %5s %4s %10s %11s %10s %9s %6s\n",
+               "category", "moves", "config", "threads", "depth", "move", "score", "nodes", "ms", "knodes/s", "bf");
+        for (int i = 0; i < count; i++) {
+            for (int c = 0; c < CONFIG_COUNT; c++) {
+                if (only >= 0 && c != only) continue;
+                const BenchRun *run = &runs[c * count + i];
+                int d = run->depth;
+                printf("%-10s %-28s %-9s %7d %5d %4d %10d %11lld %10.3f %9.1f %6.2f\n",
+                       positions[i].category, positions[i].moves, configNames[c], run->threads, d, run->bestCol + 1, run->score,
+                       d ? run->nodes[d] : 0, d ? run->ns[d] / 1e6 : 0.0, d ? knps(run->nodes[d], run->ns[d]) : 0.0,
+                       branching(run));
+            }
+        }
+        for (int c = 0; c < CONFIG_COUNT; c++) {
+            if (only >= 0 && c != only) continue;
+            long long nodes, ns;
+            configTotals(runs + c * count, count, &nodes, &ns);
+            printf("%-9s total %lld nodes, %.3f ms, %.1f knodes/s, %d threads\n", configNames[c], nodes, ns / 1e6,
+                   knps(nodes, ns), configThreads(runs + c * count, count));
+        }
+    }
+
+    /* only the listed depths promise a forced result */
+    int failed = 0;
+    for (int c = 0; c < CONFIG_COUNT && depthOverride <= 0; c++) {
+        if (only >= 0 && c != only) continue;
+        for (int i = 0; i < count; i++) {
+            if (!unproven(&positions[i], &runs[c * count + i])) continue;
+            fprintf(stderr, "%s %s not proven by %s at depth %d\n", positions[i].category, positions[i].moves,
+                    configNames[c], positions[i].depth);
+            failed++;
+        }
+    }
+
+    free(runs);
+    ttFree(&tt);
+    return failed ? 1 : 0;
+}
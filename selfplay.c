@@ -0,0 +1,262 @@
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bot.h"
+#include "threadpool.h"
+
+/* Plays two bot configurations against each other on every core, through
+ * the same botChoose the connect4 bot uses, and reports the score, the
+ * Elo difference and the time per move. Games come in pairs: both start
+ * from the same random opening, with each side moving first once.
+ * Usage: selfplay [games=1000] [A=hard] [B=medium] [--threads N]
+ *                 [--random-plies N] [--seed N] [--no-book]
+ * A configuration is easy, medium, hard or perfect, optionally followed
+ * by ,ms=N (time per move), ,depth=N (deepest iteration) and ,minimax. */
+
+#define SELFPLAY_DEFAULT_MS 100
+#define SELFPLAY_RANDOM_PLIES 4
+
+typedef struct {
+    char label[64];
+    int difficulty;
+    int budgetMs;
+    int maxDepth;
+    int searchMode;
+} BotConfig;
+
+typedef struct {
+    BotConfig configs[2];
+    const Book *book;
+    int games;
+    int randomPlies;
+    unsigned seed;
+    atomic_int next;            /* next game to hand out */
+} SelfPlay;
+
+typedef struct {
+    SelfPlay *sp;
+    int index;
+    bool ready;
+    long long wins, draws, losses;  /* from A's side */
+    long long moves[2];             /* per configuration */
+    long long ns[2];
+} SelfPlayWorker;
+
+/* "hard,ms=50,depth=10,minimax"; false if it does not parse */
+static bool parseConfig(const char *text, BotConfig *c) {
+    static const char *names[] = { "easy", "medium", "hard", "perfect" };
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    snprintf(c->label, sizeof(c->label), "%s", text);
+    c->difficulty = 0;
+    c->budgetMs = SELFPLAY_DEFAULT_MS;
+    c->maxDepth = MAX_DEPTH;
+    c->searchMode = SEARCH_PVS;
+
+    char *save;
+    char *name = strtok_r(buffer, ",", &save);
+    for (int i = 0; name && i < 4; i++)
+        if (strcmp(name, names[i]) == 0) c->difficulty = BOT_EASY + i;
+    if (!c->difficulty) return false;
+    for (char *opt = strtok_r(NULL, ",", &save); opt; opt = strtok_r(NULL, ",", &save)) {
+        if (strncmp(opt, "ms=", 3) == 0) c->budgetMs = atoi(opt + 3);
+        else if (strncmp(opt, "depth=", 6) == 0) c->maxDepth = atoi(opt + 6);
+        else if (strcmp(opt, "minimax") == 0) c->searchMode = SEARCH_MINIMAX;
+        else return false;
+    }
+    return c->budgetMs > 0 && c->maxDepth > 0;
+}
+
+static void dropPiece(char board[rows][cols], int col, char symbol) {
+    for (int i = rows - 1; i >= 0; i--) {
+        if (board[i][col] == '.') {
+            board[i][col] = symbol;
+            return;
+        }
+    }
+}
+
+/* Plays game number g: the random opening of its pair, then the bots in
+ * turn. Returns 1 if A wins, 0 for a draw and -1 if B wins. */
+static int playGame(SelfPlayWorker *w, Bot bots[2], int g) {
+    SelfPlay *sp = w->sp;
+    static const char symbols[2] = { 'X', 'O' };
+    char board[rows][cols];
+    memset(board, '.', sizeof(board));
+    Position pos;
+    positionInit(&pos);
+
+    /* the same opening for both games of a pair, and none that wins */
+    unsigned seed = sp->seed + (unsigned)(g / 2) * 2654435761u;
+    for (int ply = 0; ply < sp->randomPlies; ply++) {
+        int col, tries = 0;
+        do {
+            col = rand_r(&seed) % cols;
+        } while ((!canPlay(&pos, col) || isWinningMove(&pos, col)) && ++tries < 100);
+        if (tries == 100) break;
+        dropPiece(board, col, symbols[pos.moves & 1]);
+        playMove(&pos, col);
+    }
+
+    /* A moves first in even games; side 0 is whoever moves first */
+    int first = g & 1;
+    botNewGame(&bots[0]);
+    botNewGame(&bots[1]);
+    while (!positionFull(&pos)) {
+        int side = (pos.moves & 1) ^ first;     /* 0 is A, 1 is B */
+        BotChoice why;
+        long long start = monotonicNs();
+        int col = botChoose(&bots[side], board, symbols[pos.moves & 1], &why);
+        w->ns[side] += monotonicNs() - start;
+        w->moves[side]++;
+        if (col < 0 || !canPlay(&pos, col)) return side ? 1 : -1;
+        if (isWinningMove(&pos, col)) return side ? -1 : 1;
+        dropPiece(board, col, symbols[pos.moves & 1]);
+        playMove(&pos, col);
+    }
+    return 0;
+}
+
+static void workerMain(void *arg) {
+    SelfPlayWorker *w = arg;
+    SelfPlay *sp = w->sp;
+    Bot bots[2];
+    for (int i = 0; i < 2; i++) {
+        const BotConfig *c = &sp->configs[i];
+        if (!botInit(&bots[i], c->difficulty, sp->book, sp->seed ^ (unsigned)(2 * w->index + i + 1))) {
+            if (i) botFree(&bots[0]);
+            return;
+        }
+        bots[i].budgetMs = c->budgetMs;
+        bots[i].maxDepth = c->maxDepth;
+        bots[i].searchMode = c->searchMode;
+    }
+    w->ready = true;
+
+    int g;
+    while ((g = atomic_fetch_add(&sp->next, 1)) < sp->games) {
+        int result = playGame(w, bots, g);
+        if (result > 0) w->wins++;
+        else if (result < 0) w->losses++;
+        else w->draws++;
+    }
+    botFree(&bots[0]);
+    botFree(&bots[1]);
+}
+
+/* Elo difference for an expected score p; infinite at 0 and 1 */
+static double eloFromScore(double p) {
+    if (p <= 0) return -INFINITY;
+    if (p >= 1) return INFINITY;
+    return 400.0 * log10(p / (1 - p));
+}
+
+/* 95% Wilson interval of the score p over n games. It stays inside [0, 1]
+ * and keeps its width at a score of 0 or 1. Counting a draw as half a win
+ * makes it a little wider than it has to be, never narrower. */
+static void scoreInterval(double p, long long n, double *low, double *high) {
+    double z = 1.96, z2n = z * z / n;
+    double centre = (p + z2n / 2) / (1 + z2n);
+    double half = z * sqrt(p * (1 - p) / n + z2n / (4 * n)) / (1 + z2n);
+    /* at a score of 0 or 1 that bound is exact, but rounding misses it */
+    *low = p <= 0 ? 0 : centre - half;
+    *high = p >= 1 ? 1 : centre + half;
+}
+
+int main(int argc, char **argv) {
+    SelfPlay sp = { .games = 1000, .randomPlies = SELFPLAY_RANDOM_PLIES, .seed = (unsigned)time(NULL) };
+    const char *names[2] = { "hard", "medium" };
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    bool useBook = true;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--random-plies") == 0 && i + 1 < argc) sp.randomPlies = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) sp.seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--no-book") == 0) useBook = false;
+        else if (positional == 0) { sp.games = atoi(argv[i]); positional++; }
+        else if (positional <= 2) names[positional++ - 1] = argv[i];
+        else {
+            printf("Unexpected argument '%s'.\n", argv[i]);
+            return 1;
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (!parseConfig(names[i], &sp.configs[i])) {
+            printf("Bad configuration '%s': easy, medium, hard or perfect, then ,ms=N ,depth=N ,minimax\n", names[i]);
+            return 1;
+        }
+    }
+    if (sp.games < 1) sp.games = 1;
+    if (sp.randomPlies < 0) sp.randomPlies = 0;
+    if (threads < 1) threads = 1;
+    if (threads > POOL_QUEUE_SIZE) threads = POOL_QUEUE_SIZE;
+    if (threads > sp.games) threads = sp.games;
+
+    engineInit();
+    Book book = { 0 };
+    if (useBook && bookOpen(&book, BOOK_DEFAULT_PATH)) sp.book = &book;
+    atomic_init(&sp.next, 0);
+
+    SelfPlayWorker *workers = calloc(threads, sizeof(SelfPlayWorker));
+    ThreadPool pool;
+    if (!workers || !poolInit(&pool, threads, -1)) {
+        printf("Could not start the worker threads.\n");
+        return 1;
+    }
+    printf("%s vs %s: %d games on %d threads, openings of %d random plies, seed %u%s\n",
+           sp.configs[0].label, sp.configs[1].label, sp.games, threads, sp.randomPlies, sp.seed,
+           sp.book ? ", opening book" : "");
+    fflush(stdout);
+
+    long long start = monotonicNs();
+    for (int i = 0; i < threads; i++) {
+        workers[i].sp = &sp;
+        workers[i].index = i;
+        poolSubmit(&pool, workerMain, &workers[i]);
+    }
+    poolWait(&pool);
+    long long elapsed = monotonicNs() - start;
+    poolFree(&pool);
+
+    long long wins = 0, draws = 0, losses = 0, moves[2] = { 0, 0 }, ns[2] = { 0, 0 };
+    bool ready = false;
+    for (int i = 0; i < threads; i++) {
+        ready |= workers[i].ready;
+        wins += workers[i].wins;
+        draws += workers[i].draws;
+        losses += workers[i].losses;
+        for (int k = 0; k < 2; k++) {
+            moves[k] += workers[i].moves[k];
+            ns[k] += workers[i].ns[k];
+        }
+    }
+    free(workers);
+    if (!ready) {
+        printf("Not enough memory for the bots' tables.\n");
+        return 1;
+    }
+
+    /* score per game is 1, 1/2 or 0; the interval is taken on the score
+     * and then converted, so it is not symmetric around the Elo */
+    long long n = wins + draws + losses;
+    double p = (wins + 0.5 * draws) / n;
+    double low, high;
+    scoreInterval(p, n, &low, &high);
+
+    printf("%s: %lld wins, %lld draws, %lld losses, score %.1f%%\n",
+           sp.configs[0].label, wins, draws, losses, 100 * p);
+    printf("Elo difference: %+.1f (95%%: %+.1f to %+.1f)\n", eloFromScore(p), eloFromScore(low), eloFromScore(high));
+    for (int k = 0; k < 2; k++)
+        printf("%s: %lld moves, %.3f ms per move\n", sp.configs[k].label, moves[k],
+               moves[k] ? ns[k] / 1e6 / moves[k] : 0.0);
+    printf("%.1f s, %.1f games/s\n", elapsed / 1e9, n / (elapsed / 1e9));
+
+    if (sp.book) bookClose(&book);
+    return 0;
+}
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -7,11 +8,13 @@
 #include <stdint.h>
 
 #include <sys/socket.h>
+#include <sys/epoll.h>
 #include <arpa/inet.h>
+#include <errno.h>
 #include <unistd.h>
 
-#define rows 6
-#define cols 7
+#include "botseat.h"
+#include "protocol.h"
 
 void initialize(char board[rows][cols]) {
     for (int i=0;i<rows;i++) for (int j=0;j<cols;j++) board[i][j]='.';
@@ -33,18 +36,13 @@ bool update(char board[rows][cols], int col, char player) {
 }
 
 bool checkWin(char board[rows][cols], char player) {
-    for (int r=0;r<rows;r++) for (int c=0;c<=cols-4;c++)
-        if (board[r][c]==player && board[r][c+1]==player && board[r][c+2]==player && board[r][c+3]==player) return true;
-
-    for (int c=0;c<cols;c++) for (int r=0;r<=rows-4;r++)
-        if (board[r][c]==player && board[r+1][c]==player && board[r+2][c]==player && board[r+3][c]==player) return true;
-
-    for (int r=3;r<rows;r++) for (int c=0;c<=cols-4;c++)
-        if (board[r][c]==player && board[r-1][c+1]==player && board[r-2][c+2]==player && board[r-3][c+3]==player) return true;
-
-    for (int r=0;r<=rows-4;r++) for (int c=0;c<=cols-4;c++)
-        if (board[r][c]==player && board[r+1][c+1]==player && board[r+2][c+2]==player && board[r+3][c+3]==player) return true;
-
+    /* right, down, up-right and down-right from every cell */
+    static const int dirs[4][2] = { {0,1}, {1,0}, {-1,1}, {1,1} };
+    for (int d=0;d<4;d++) for (int i=0;i<rows;i++) for (int j=0;j<cols;j++) {
+        int k=0;
+        while (k<CONNECT) { int r=i+k*dirs[d][0], c=j+k*dirs[d][1]; if (r<0 || r>=rows || c>=cols || board[r][c]!=player) break; k++; }
+        if (k==CONNECT) return true;
+    }
     return false;
 }
 
@@ -103,11 +101,13 @@ int recv_int(int sock, int *out) {
     return 0;
 }
 
+/* one send for the board and both flags */
 int send_board_and_flags(int sock, char board[rows][cols], int status, int yourTurn) {
-    if (send_all(sock, board, sizeof(char)*rows*cols) < 0) return -1;
-    send_int(sock, status);
-    send_int(sock, yourTurn);
-    return 0;
+    unsigned char frame[rows * cols + 8];
+    int32_t net[2] = { htonl(status), htonl(yourTurn) };
+    memcpy(frame, board, rows * cols);
+    memcpy(frame + rows * cols, net, sizeof(net));
+    return send_all(sock, frame, sizeof(frame));
 }
 
 /* ---------- Server socket ---------- */
@@ -134,10 +134,473 @@ int start_server(int port) {
     return client;
 }
 
+/* ---------- Multi-game server ----------
+ * server --multi [port] [mode] hosts any number of games at once, each
+ * one a client playing O against the server's own X, with the protocol
+ * of the one-game server: the mode int, then after every move the board,
+ * the status and yourTurn, and a move int back from the client. One
+ * thread runs a non-blocking epoll loop; every connection is a small
+ * state machine that reads a move only when one is due and keeps what
+ * it could not send yet, so the number of games is bounded by memory.
+ * The server plays like the Medium bot: win, block, then center-out,
+ * or with --bot ms it plays Hard from a seat of engine workers (botseat.c)
+ * shared by every game: a game asks for a move and waits, without
+ * holding a thread, until the seat's eventfd says the answer is in.
+ * Clients of the compact protocol (protocol.h) connect to a port of their
+ * own, the next one up unless --compact-port says otherwise (0 for none).
+ * Whatever a round has to say goes out in one send.
+ * Usage: server --multi [port] [mode] [--bot ms] [--workers N] [--deadline ms]
+ *                       [--compact-port port] */
+
+#define FRAME_SIZE (rows * cols + 8)    /* board, status, yourTurn */
+#define OUT_BUFFER 256                  /* a round of either protocol, with room to spare */
+#define MAX_EVENTS 256
+#define STATS_INTERVAL_MS 10000
+#define ACCEPT_RETRY_MS 100             /* out of descriptors: try the listeners again this often */
+
+enum {
+    GAME_AWAIT_HELLO,           /* compact: the client's version is due */
+    GAME_AWAIT_MOVE,            /* the client is to move */
+    GAME_AWAIT_BOT,             /* the server's move is with the seat */
+    GAME_CLOSING                /* over once the output is sent */
+};
+
+typedef struct Game Game;
+
+struct Game {
+    int fd;
+    int state;
+    unsigned events;            /* what epoll watches for */
+    bool compact;               /* protocol.h, otherwise the legacy protocol */
+    bool closed;                /* connection gone: events for it still in the batch are stale */
+    Game *nextClosed;           /* on MultiServer.closedGames */
+    uint32_t id;
+    int ply;                    /* stones on the board */
+    BotRequest request;
+    char board[rows][cols];
+    unsigned char in[MSG_MAX + 1];  /* a move int or a message, as far as it came */
+    int inLen;
+    unsigned char out[OUT_BUFFER];
+    int outStart, outEnd;       /* out[outStart .. outEnd - 1] is still to send */
+};
+
+typedef struct {
+    int epoll;
+    int listener;
+    int compactListener;        /* -1 if none */
+    int mode;                   /* sent to every client */
+    BotSeat *seat;              /* NULL: the server moves like Medium */
+    int deadlineMs;             /* for a move from the seat */
+    long long open, started, finished, moves;
+    Game *closedGames;          /* freed once the current batch of events is done */
+    bool acceptPaused;          /* out of file descriptors: listeners unwatched */
+    long long acceptRetryAt;    /* monotonic ns to watch them again, closed game or not */
+    bool outOfFds;              /* reported, until the accept queue drains */
+} MultiServer;
+
+/* epoll data of everything that is not a game */
+static char legacyMarker, compactMarker, seatMarker;
+
+/* events 0 stops watching the listeners, EPOLLIN watches them again */
+static void watchListeners(MultiServer *ms, uint32_t events) {
+    struct epoll_event ev = { .events = events, .data.ptr = &legacyMarker };
+    epoll_ctl(ms->epoll, EPOLL_CTL_MOD, ms->listener, &ev);
+    if (ms->compactListener >= 0) {
+        struct epoll_event compactEv = { .events = events, .data.ptr = &compactMarker };
+        epoll_ctl(ms->epoll, EPOLL_CTL_MOD, ms->compactListener, &compactEv);
+    }
+    ms->acceptPaused = events == 0;
+}
+
+/* highest empty row of col, -1 if full */
+static int freeRow(char board[rows][cols], int col) {
+    for (int i = rows - 1; i >= 0; i--)
+        if (board[i][col] == '.') return i;
+    return -1;
+}
+
+static bool winsWith(char board[rows][cols], int col, char player) {
+    int r = freeRow(board, col);
+    if (r < 0) return false;
+    board[r][col] = player;
+    bool win = checkWin(board, player);
+    board[r][col] = '.';
+    return win;
+}
+
+static int serverMove(char board[rows][cols], char self, char other) {
+    for (int c = 0; c < cols; c++)
+        if (winsWith(board, c, self)) return c;
+    for (int c = 0; c < cols; c++)
+        if (winsWith(board, c, other)) return c;
+    for (int k = 0; k < cols; k++) {
+        int c = cols / 2 + ((k & 1) ? (k + 1) / 2 : -(k + 1) / 2);
+        if (freeRow(board, c) >= 0) return c;
+    }
+    return -1;
+}
+
+/* room for n more bytes, after moving what is still unsent to the front;
+ * a client that lets this much pile up unsent is dropped */
+static unsigned char *queueSpace(Game *g, int n) {
+    if (g->outStart > 0 && g->outEnd + n > OUT_BUFFER) {
+        memmove(g->out, g->out + g->outStart, g->outEnd - g->outStart);
+        g->outEnd -= g->outStart;
+        g->outStart = 0;
+    }
+    if (g->outEnd + n > OUT_BUFFER) {
+        g->state = GAME_CLOSING;
+        return NULL;
+    }
+    unsigned char *p = g->out + g->outEnd;
+    g->outEnd += n;
+    return p;
+}
+
+static void queueInt(Game *g, int x) {
+    int32_t net = htonl(x);
+    unsigned char *p = queueSpace(g, sizeof(net));
+    if (p) memcpy(p, &net, sizeof(net));
+}
+
+static void queueFrame(Game *g, int status, int yourTurn) {
+    unsigned char *p = queueSpace(g, FRAME_SIZE);
+    if (!p) return;
+    int32_t net[2] = { htonl(status), htonl(yourTurn) };
+    memcpy(p, g->board, sizeof(g->board));
+    memcpy(p + sizeof(g->board), net, sizeof(net));
+}
+
+static void queueBoard(MultiServer *ms, Game *g, int status) {
+    unsigned char *p = queueSpace(g, MSG_BOARD_SIZE);
+    if (p) msgBoard(p, ms->mode, g->id, g->ply, status, g->state == GAME_AWAIT_MOVE, g->board);
+}
+
+static void queueMove(Game *g, int col, int status) {
+    unsigned char *p = queueSpace(g, MSG_MOVE_SIZE);
+    if (p) msgMove(p, g->id, g->ply - 1, col, status, status == 0);
+}
+
+/* plays the server's move and queues what hands the turn to the client */
+static void finishServerTurn(MultiServer *ms, Game *g, int col) {
+    update(g->board, col, 'X');
+    g->ply++;
+    ms->moves++;
+    int status = 0;
+    if (checkWin(g->board, 'X')) status = 1;
+    else if (boardFull(g->board)) status = 3;
+    g->state = (status == 0) ? GAME_AWAIT_MOVE : GAME_CLOSING;
+    if (g->compact) queueMove(g, col, status);
+    else queueFrame(g, status, status == 0);
+}
+
+static void serverTurn(MultiServer *ms, Game *g) {
+    if (!ms->seat) {
+        finishServerTurn(ms, g, serverMove(g->board, 'X', 'O'));
+        return;
+    }
+    memcpy(g->request.board, g->board, sizeof(g->board));
+    g->request.symbol = 'X';
+    g->request.deadline = monotonicNs() + ms->deadlineMs * 1000000LL;
+    g->request.owner = g;
+    g->state = GAME_AWAIT_BOT;
+    seatSubmit(ms->seat, &g->request);
+}
+
+static void freeLater(MultiServer *ms, Game *g) {
+    g->nextClosed = ms->closedGames;
+    ms->closedGames = g;
+}
+
+/* Later events of the same epoll_wait batch may still point at g, so it
+ * is only freed after the batch; one the seat still has a move for, once
+ * the answer comes. Its descriptor is free at once, so accepting resumes. */
+static void closeGame(MultiServer *ms, Game *g) {
+    if (g->closed) return;
+    epoll_ctl(ms->epoll, EPOLL_CTL_DEL, g->fd, NULL);
+    close(g->fd);
+    if (ms->acceptPaused) watchListeners(ms, EPOLLIN);
+    g->closed = true;
+    ms->open--;
+    ms->finished += g->state == GAME_CLOSING;
+    if (g->state != GAME_AWAIT_BOT) freeLater(ms, g);
+}
+
+/* sends everything queued in one call if the socket takes it; false
+ * once the game is over and closed */
+static bool flushGame(MultiServer *ms, Game *g) {
+    while (g->outStart < g->outEnd) {
+        ssize_t n = send(g->fd, g->out + g->outStart, g->outEnd - g->outStart, MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) {
+            closeGame(ms, g);
+            return false;
+        }
+        g->outStart += n;
+    }
+    if (g->outStart == g->outEnd) {
+        g->outStart = g->outEnd = 0;
+        if (g->state == GAME_CLOSING) {
+            closeGame(ms, g);
+            return false;
+        }
+    }
+    /* read only when something is due, wait for room only while something is left */
+    bool reading = g->state == GAME_AWAIT_MOVE || g->state == GAME_AWAIT_HELLO;
+    unsigned events = (reading ? EPOLLIN : 0) | (g->outStart < g->outEnd ? EPOLLOUT : 0);
+    if (events != g->events) {
+        struct epoll_event ev = { .events = events, .data.ptr = g };
+        epoll_ctl(ms->epoll, EPOLL_CTL_MOD, g->fd, &ev);
+        g->events = events;
+    }
+    return true;
+}
+
+/* the client's move; the legacy protocol answers with the board at once */
+static void clientTurn(MultiServer *ms, Game *g, int col) {
+    if (col < 0 || col >= cols || !update(g->board, col, 'O')) {
+        /* as the one-game server does: an invalid move ends the game */
+        g->state = GAME_CLOSING;
+        return;
+    }
+    g->ply++;
+    ms->moves++;
+    if (checkWin(g->board, 'O') || boardFull(g->board)) {
+        int status = checkWin(g->board, 'O') ? 2 : 3;
+        g->state = GAME_CLOSING;
+        if (g->compact) queueMove(g, col, status);
+        else queueFrame(g, status, 0);
+        return;
+    }
+    if (!g->compact) queueFrame(g, 0, 0);
+    serverTurn(ms, g);
+}
+
+/* one whole compact message from the client */
+static void compactMessage(MultiServer *ms, Game *g, const unsigned char *m, int size) {
+    int type = size >= 2 ? m[1] : 0;
+    if (g->state == GAME_AWAIT_HELLO) {
+        /* a version this server does not speak ends the game at once */
+        if (type != MSG_HELLO || size != MSG_HELLO_SIZE || m[2] != PROTOCOL_VERSION) {
+            g->state = GAME_CLOSING;
+            return;
+        }
+        g->state = GAME_AWAIT_BOT;      /* nothing to read until the first move is out */
+        queueBoard(ms, g, 0);
+        serverTurn(ms, g);
+    } else if (type == MSG_PLAY && size == MSG_PLAY_SIZE) {
+        /* a move for a board the client no longer has: send it the real one */
+        if (m[2] != g->ply) queueBoard(ms, g, 0);
+        else clientTurn(ms, g, m[3]);
+    } else if (type == MSG_RESYNC && size == MSG_RESYNC_SIZE) {
+        queueBoard(ms, g, 0);
+    } else {
+        g->state = GAME_CLOSING;
+    }
+}
+
+static void readGame(MultiServer *ms, Game *g) {
+    while (g->state == GAME_AWAIT_MOVE || g->state == GAME_AWAIT_HELLO) {
+        int want = g->compact ? (int)sizeof(g->in) : 4;
+        ssize_t n = recv(g->fd, g->in + g->inLen, want - g->inLen, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) {
+            closeGame(ms, g);
+            return;
+        }
+        g->inLen += n;
+        if (!g->compact) {
+            if (g->inLen < 4) continue;
+            int32_t net;
+            memcpy(&net, g->in, sizeof(net));
+            g->inLen = 0;
+            clientTurn(ms, g, (int)ntohl(net));
+            /* a client that sends before its turn is read on the next round */
+            break;
+        }
+        /* every whole message that came, as long as the game takes input */
+        int used = 0, size;
+        while ((g->state == GAME_AWAIT_MOVE || g->state == GAME_AWAIT_HELLO) &&
+               (size = msgComplete(g->in + used, g->inLen - used)) > 0) {
+            compactMessage(ms, g, g->in + used, size);
+            used += size;
+        }
+        memmove(g->in, g->in + used, g->inLen - used);
+        g->inLen -= used;
+    }
+    flushGame(ms, g);
+}
+
+static void acceptGames(MultiServer *ms, bool compact) {
+    while (true) {
+        int fd = accept4(compact ? ms->compactListener : ms->listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            /* the pending connection stays queued and the listener readable,
+             * so wait for a game to close instead of spinning on it */
+            if (errno == EMFILE || errno == ENFILE) {
+                if (!ms->outOfFds) perror("accept");
+                ms->outOfFds = true;
+                watchListeners(ms, 0);
+                ms->acceptRetryAt = monotonicNs() + ACCEPT_RETRY_MS * 1000000LL;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                ms->outOfFds = false;
+            } else if (errno != EINTR) {
+                perror("accept");
+            }
+            return;
+        }
+        Game *g = calloc(1, sizeof(Game));
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = g };
+        if (!g || epoll_ctl(ms->epoll, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            free(g);
+            close(fd);
+            continue;
+        }
+        g->fd = fd;
+        g->events = EPOLLIN;
+        g->compact = compact;
+        g->id = (uint32_t)++ms->started;
+        initialize(g->board);
+        ms->open++;
+        if (compact) {
+            g->state = GAME_AWAIT_HELLO;
+            continue;
+        }
+        queueInt(g, ms->mode);
+        serverTurn(ms, g);
+        flushGame(ms, g);
+    }
+}
+
+/* the seat's answers: play them and send them on */
+static void collectBotMoves(MultiServer *ms) {
+    BotRequest *r = seatCollect(ms->seat);
+    while (r) {
+        BotRequest *next = r->next;
+        Game *g = r->owner;
+        if (g->closed) {
+            freeLater(ms, g);
+        } else {
+            finishServerTurn(ms, g, r->col);
+            flushGame(ms, g);
+        }
+        r = next;
+    }
+}
+
+static int listenOn(int port) {
+    int s = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s < 0) { perror("socket"); return -1; }
+    int opt = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = INADDR_ANY };
+    if (bind(s, (struct sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind"); close(s); return -1; }
+    if (listen(s, SOMAXCONN) < 0) { perror("listen"); close(s); return -1; }
+    return s;
+}
+
+static int runMultiServer(int port, int compactPort, int mode, BotSeat *seat, int deadlineMs) {
+    MultiServer ms = { .mode = mode, .seat = seat, .deadlineMs = deadlineMs, .compactListener = -1 };
+    if ((ms.listener = listenOn(port)) < 0) return 1;
+    if (compactPort > 0 && (ms.compactListener = listenOn(compactPort)) < 0) return 1;
+
+    ms.epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (ms.epoll < 0) { perror("epoll"); return 1; }
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &legacyMarker };
+    struct epoll_event compactEv = { .events = EPOLLIN, .data.ptr = &compactMarker };
+    struct epoll_event seatEv = { .events = EPOLLIN, .data.ptr = &seatMarker };
+    if (epoll_ctl(ms.epoll, EPOLL_CTL_ADD, ms.listener, &ev) < 0 ||
+        (ms.compactListener >= 0 && epoll_ctl(ms.epoll, EPOLL_CTL_ADD, ms.compactListener, &compactEv) < 0) ||
+        (seat && epoll_ctl(ms.epoll, EPOLL_CTL_ADD, seat->notify, &seatEv) < 0)) {
+        perror("epoll");
+        return 1;
+    }
+    printf("Hosting games on port %d", port);
+    if (compactPort > 0) printf(", compact protocol on port %d", compactPort);
+    printf(" (mode %d)...\n", mode);
+    fflush(stdout);
+
+    struct epoll_event events[MAX_EVENTS];
+    long long lastFinished = -1;
+    long long nextStats = monotonicNs() + STATS_INTERVAL_MS * 1000000LL;
+    while (true) {
+        /* the stats come on the clock, however busy the games keep us */
+        int timeoutMs = (int)((nextStats - monotonicNs()) / 1000000) + 1;
+        if (timeoutMs < 0) timeoutMs = 0;
+        if (ms.acceptPaused && timeoutMs > ACCEPT_RETRY_MS) timeoutMs = ACCEPT_RETRY_MS;
+        int n = epoll_wait(ms.epoll, events, MAX_EVENTS, timeoutMs);
+        if (n < 0 && errno != EINTR) { perror("epoll_wait"); return 1; }
+        for (int i = 0; i < n; i++) {
+            void *data = events[i].data.ptr;
+            if (data == &legacyMarker || data == &compactMarker) {
+                acceptGames(&ms, data == &compactMarker);
+                continue;
+            }
+            if (data == &seatMarker) {
+                collectBotMoves(&ms);
+                continue;
+            }
+            Game *g = data;
+            if (g->closed) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeGame(&ms, g);
+                continue;
+            }
+            if ((events[i].events & EPOLLOUT) && !flushGame(&ms, g)) continue;
+            if (events[i].events & EPOLLIN) readGame(&ms, g);
+        }
+        while (ms.closedGames) {
+            Game *g = ms.closedGames;
+            ms.closedGames = g->nextClosed;
+            free(g);
+        }
+        /* descriptors may free up without a game of ours closing */
+        long long now = monotonicNs();
+        if (ms.acceptPaused && now >= ms.acceptRetryAt) watchListeners(&ms, EPOLLIN);
+        if (now < nextStats) continue;
+        nextStats = now + STATS_INTERVAL_MS * 1000000LL;
+        if (ms.finished != lastFinished) {
+            printf("%lld games open, %lld started, %lld finished, %lld moves\n", ms.open, ms.started, ms.finished, ms.moves);
+            if (seat) {
+                pthread_mutex_lock(&seat->lock);
+                printf("seat: %lld moves, %lld late, %.3f ms average wait\n", seat->answered, seat->late,
+                       seat->answered ? seat->waitNs / 1e6 / seat->answered : 0.0);
+                pthread_mutex_unlock(&seat->lock);
+            }
+            fflush(stdout);
+            lastFinished = ms.finished;
+        }
+    }
+}
+
 /* ---------- Main ---------- */
 
 int main(int argc, char **argv) {
     srand((unsigned int)time(NULL));
+    if (argc >= 2 && strcmp(argv[1], "--multi") == 0) {
+        int port = 9000, compactPort = -1, mode = 2, botMs = 0, deadlineMs = 0;
+        int workers = (int)sysconf(_SC_NPROCESSORS_ONLN), positional = 0;
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--bot") == 0 && i + 1 < argc) botMs = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) workers = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--deadline") == 0 && i + 1 < argc) deadlineMs = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--compact-port") == 0 && i + 1 < argc) compactPort = atoi(argv[++i]);
+            else if (positional++ == 0) port = atoi(argv[i]);
+            else mode = atoi(argv[i]);
+        }
+        if (compactPort < 0) compactPort = port + 1;
+        if (botMs <= 0) return runMultiServer(port, compactPort, (mode == 1) ? 1 : 2, NULL, 0);
+
+        static Book book;
+        static BotSeat seat;
+        bookOpen(&book, BOOK_DEFAULT_PATH);
+        if (!seatInit(&seat, workers, BOT_HARD, botMs, &book)) {
+            printf("Not enough memory for the bot workers.\n");
+            return 1;
+        }
+        printf("Bot seat: %d workers, %d ms per move\n", seat.workerCount, botMs);
+        return runMultiServer(port, compactPort, (mode == 1) ? 1 : 2, &seat, deadlineMs > 0 ? deadlineMs : 3 * botMs);
+    }
     int port = 9000;
     if (argc >= 2) port = atoi(argv[1]);
 
@@ -211,4 +674,4 @@ int main(int argc, char **argv) {
 
     close(clientSock);
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+#include "solver.h"
+
+/* Solves positions given as move sequences (columns 1-7, one game per
+ * line), optionally followed by the expected score, and reports timing.
+ * --weak only resolves win/draw/loss, --best finds the best column as
+ * Perfect does (solverBestMove), --reference checks every result against
+ * a plain full-width alpha-beta search (endgames only). */
+
+static long long referenceNodes;
+
+static int referenceSearch(Position *pos, int alpha, int beta) {
+    referenceNodes++;
+    for (int c = 0; c < cols; c++)
+        if (canPlay(pos, c) && isWinningMove(pos, c)) return (rows * cols + 1 - pos->moves) / 2;
+    if (pos->moves == rows * cols) return 0;
+    int best = -rows * cols;
+    for (int c = 0; c < cols; c++) {
+        if (!canPlay(pos, c)) continue;
+        playMove(pos, c);
+        int score = -referenceSearch(pos, -beta, -alpha);
+        undoMove(pos, c);
+        if (score > best) best = score;
+        if (best > alpha) alpha = best;
+        if (alpha >= beta) break;
+    }
+    return best;
+}
+
+/* plays a line of digits; false if a move is illegal or ends the game */
+static bool parseMoves(const char *line, Position *pos, int *length) {
+    positionInit(pos);
+    int n = 0;
+    while (line[n] >= '1' && line[n] <= '9') {
+        int col = line[n] - '1';
+        if (!canPlay(pos, col) || isWinningMove(pos, col)) return false;
+        playMove(pos, col);
+        n++;
+    }
+    *length = n;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool weak = false, best = false, reference = false;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--weak") == 0) weak = true;
+        else if (strcmp(argv[i], "--best") == 0) best = true;
+        else if (strcmp(argv[i], "--reference") == 0) reference = true;
+        else path = argv[i];
+    }
+    if (best) weak = false;             /* solverBestMove is always exact */
+
+    FILE *in = stdin;
+    if (path && !(in = fopen(path, "r"))) { perror("fopen"); return 1; }
+
+    engineInit();
+    Solver solver;
+    if (!solverInit(&solver, SOLVER_DEFAULT_BITS)) { printf("Not enough memory for the solver table.\n"); return 1; }
+
+    char line[256];
+    int count = 0, mismatches = 0;
+    long long totalNodes = 0, totalNs = 0, worstNs = 0;
+    while (fgets(line, sizeof(line), in)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        Position pos;
+        int length;
+        if (!parseMoves(line, &pos, &length)) {
+            printf("skipping invalid line: %s", line);
+            continue;
+        }
+        int expected;
+        bool hasExpected = sscanf(line + length, "%d", &expected) == 1;
+
+        solverReset(&solver);
+        long long start = monotonicNs();
+        int score, col = -1;
+        if (best) col = solverBestMove(&solver, &pos, &score);
+        else score = solve(&solver, &pos, weak);
+        long long ns = monotonicNs() - start;
+
+        bool ok = true;
+        if (hasExpected) {
+            if (weak) ok = (score > 0) == (expected > 0) && (score < 0) == (expected < 0);
+            else ok = score == expected;
+        }
+        if (reference) {
+            referenceNodes = 0;
+            int ref = referenceSearch(&pos, -rows * cols, rows * cols);
+            if (weak) ok = ok && (score > 0) == (ref > 0) && (score < 0) == (ref < 0);
+            else ok = ok && score == ref;
+        }
+
+        printf("%.*s %d", length, line, score);
+        if (best) printf(" col %d", col + 1);
+        printf(" %lld nodes %.3f ms%s\n", solver.nodes, ns / 1e6, ok ? "" : "  MISMATCH");
+        count++;
+        if (!ok) mismatches++;
+        totalNodes += solver.nodes;
+        totalNs += ns;
+        if (ns > worstNs) worstNs = ns;
+    }
+    if (in != stdin) fclose(in);
+
+    if (count > 0) {
+        printf("%d positions, %d mismatches, mean %.3f ms, worst %.3f ms, mean %lld nodes, %.0f knodes/s\n",
+               count, mismatches, totalNs / 1e6 / count, worstNs / 1e6, totalNodes / count,
+               totalNs ? totalNodes / (totalNs / 1e9) / 1000 : 0.0);
+    }
+    solverFree(&solver);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "solver.h"
+#include "engine.h"
+
+/* ---------- Table ---------- */
+
+/* an upper bound u is stored as u - MIN + 1, a lower bound l as
+ * l + MAX - 2 * MIN + 2, so both fit in a signed byte and 0 means empty */
+#define UPPER_OFFSET (1 - SOLVER_MIN_SCORE)
+#define LOWER_OFFSET (SOLVER_MAX_SCORE - 2 * SOLVER_MIN_SCORE + 2)
+
+bool solverInit(Solver *s, int bits) {
+    size_t size = (size_t)1 << bits;
+    *s = (Solver){0};
+    s->table.keys = calloc(size, sizeof(uint64_t));
+    s->table.values = calloc(size, sizeof(int8_t));
+    s->table.moves = calloc(size, sizeof(int8_t));
+    if (!s->table.keys || !s->table.values || !s->table.moves) {
+        solverFree(s);
+        return false;
+    }
+    s->table.mask = size - 1;
+    return true;
+}
+
+void solverFree(Solver *s) {
+    free(s->table.keys);
+    free(s->table.values);
+    free(s->table.moves);
+    s->table = (SolverTable){0};
+}
+
+void solverReset(Solver *s) {
+    for (size_t i = 0; i <= s->table.mask; i++) s->table.values[i] = 0;
+    s->nodes = 0;
+}
+
+/* current + mask identifies a position exactly. A position and its mirror
+ * image have the same score, so both are stored under the smaller of their
+ * two keys; *mirrored says whether that is the mirror image's. */
+static uint64_t tableKey(const Position *pos, bool *mirrored) {
+    bitboard key = pos->current + pos->mask, flipped = 0;
+    for (int c = 0; c < cols; c++)
+        flipped |= ((key >> (c * BB_H)) & (((bitboard)1 << BB_H) - 1)) << ((cols - 1 - c) * BB_H);
+    *mirrored = flipped < key;
+    return (uint64_t)(*mirrored ? flipped : key);
+}
+
+/* the multiply spreads the key over the index bits */
+static size_t tableIndex(const SolverTable *t, uint64_t key) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 20) & t->mask;
+}
+
+/* the stored bound, 0 if none; *move is the column that proved a lower
+ * bound, -1 if none */
+static int tableGet(const SolverTable *t, uint64_t key, bool mirrored, int *move) {
+    size_t i = tableIndex(t, key);
+    *move = -1;
+    if (t->keys[i] != key || !t->values[i]) return 0;
+    if (t->moves[i] >= 0) *move = mirrored ? cols - 1 - t->moves[i] : t->moves[i];
+    return t->values[i];
+}
+
+static void tablePut(SolverTable *t, uint64_t key, bool mirrored, int value, int move) {
+    size_t i = tableIndex(t, key);
+    t->keys[i] = key;
+    t->values[i] = (int8_t)value;
+    t->moves[i] = (int8_t)(move < 0 || !mirrored ? move : cols - 1 - move);
+}
+
+bool solverStopped(Solver *s) {
+    if (!s->stop) return false;
+    if (s->deadline && (s->nodes & 1023) == 0 && monotonicNs() >= s->deadline)
+        atomic_store_explicit(s->stop, true, memory_order_relaxed);
+    return atomic_load_explicit(s->stop, memory_order_relaxed);
+}
+
+/* ---------- Search ---------- */
+
+/* Negamax for positions where the side to move cannot win at once. Moves
+ * that hand the opponent a win are never generated, and the remaining ones
+ * are tried in order of how many winning cells they create. */
+static int negamaxSolve(Solver *s, Position *pos, int alpha, int beta) {
+    s->nodes++;
+    if (solverStopped(s)) return 0;
+
+    bitboard next = nonLosingMoves(pos);
+    if (next == 0) return -(rows * cols - pos->moves) / 2;
+    if (pos->moves >= rows * cols - 2) return 0;
+
+    int min = -(rows * cols - 2 - pos->moves) / 2;
+    if (alpha < min) {
+        alpha = min;
+        if (alpha >= beta) return alpha;
+    }
+    int max = (rows * cols - 1 - pos->moves) / 2;
+    if (beta > max) {
+        beta = max;
+        if (alpha >= beta) return beta;
+    }
+
+    bool mirrored;
+    uint64_t key = tableKey(pos, &mirrored);
+    int hashMove;
+    int val = tableGet(&s->table, key, mirrored, &hashMove);
+    if (val) {
+        if (val > SOLVER_MAX_SCORE - SOLVER_MIN_SCORE + 1) {
+            min = val - LOWER_OFFSET;
+            if (alpha < min) {
+                alpha = min;
+                if (alpha >= beta) return alpha;
+            }
+        } else {
+            max = val - UPPER_OFFSET;
+            if (beta > max) {
+                beta = max;
+                if (alpha >= beta) return beta;
+            }
+        }
+    }
+
+    int order[cols], keys[cols], count = 0;
+    for (int k = 0; k < cols; k++) {
+        int col = centerOrder[k];
+        bitboard move = next & columnMask(col);
+        if (!move) continue;
+        /* the move that last refuted this position goes first */
+        int key2 = col == hashMove ? cols * rows : bbPopcount(winningCells(pos->current | move, pos->mask | move));
+        int i = count++;
+        while (i > 0 && keys[i - 1] < key2) {
+            keys[i] = keys[i - 1];
+            order[i] = order[i - 1];
+            i--;
+        }
+        keys[i] = key2;
+        order[i] = col;
+    }
+
+    for (int i = 0; i < count; i++) {
+        playMove(pos, order[i]);
+        int score = -negamaxSolve(s, pos, -beta, -alpha);
+        undoMove(pos, order[i]);
+        if (solverStopped(s)) return 0;
+        if (score >= beta) {
+            tablePut(&s->table, key, mirrored, score + LOWER_OFFSET, order[i]);
+            return score;
+        }
+        if (score > alpha) alpha = score;
+    }
+
+    tablePut(&s->table, key, mirrored, alpha + UPPER_OFFSET, -1);
+    return alpha;
+}
+
+/* narrows [min, max] with null-window searches, probing near 0 first
+ * since most positions are close to a draw */
+int solve(Solver *s, const Position *pos, bool weak) {
+    if (canWinNext(pos)) return (rows * cols + 1 - pos->moves) / 2;
+
+    Position work = *pos;
+    int min = -(rows * cols - pos->moves) / 2;
+    int max = (rows * cols + 1 - pos->moves) / 2;
+    if (weak) {
+        min = -1;
+        max = 1;
+    }
+    while (min < max) {
+        int med = min + (max - min) / 2;
+        if (med <= 0 && min / 2 < med) med = min / 2;
+        else if (med >= 0 && max / 2 > med) med = max / 2;
+        int r = negamaxSolve(s, &work, med, med + 1);
+        if (solverStopped(s)) return 0;
+        if (r <= med) max = r;
+        else min = r;
+    }
+    return min;
+}
+
+/* Only the first column is solved exactly. Every later one needs a single
+ * null-window search to show that it is no better than the best so far,
+ * and is solved exactly only when it is better. */
+int solverBestMove(Solver *s, const Position *pos, int *score) {
+    int best = -1, bestScore = 0;
+    Position work = *pos;
+    for (int k = 0; k < cols; k++) {
+        int col = centerOrder[k];
+        if (!canPlay(&work, col)) continue;
+        int sc;
+        if (isWinningMove(&work, col)) {
+            sc = (rows * cols + 1 - work.moves) / 2;
+        } else {
+            playMove(&work, col);
+            /* negamaxSolve needs a position the side to move cannot win at once */
+            if (best < 0 || canWinNext(&work) || negamaxSolve(s, &work, -bestScore - 1, -bestScore) < -bestScore)
+                sc = -solve(s, &work, false);
+            else
+                sc = bestScore;
+            undoMove(&work, col);
+            if (solverStopped(s)) return -1;
+        }
+        if (best < 0 || sc > bestScore) {
+            best = col;
+            bestScore = sc;
+        }
+    }
+    *score = bestScore;
+    return best;
+}
+
+int solverPliesToEnd(const Position *pos, int score) {
+    if (score == 0) return rows * cols - pos->moves;
+    /* score = (cells + 1 - m) / 2 rounded down, m = stones before the winning one */
+    int winnerParity = (score > 0) ? (pos->moves & 1) : !(pos->moves & 1);
+    int a = score > 0 ? score : -score;
+    int m = rows * cols + 1 - 2 * a;
+    if ((m & 1) != winnerParity) m--;
+    return m - pos->moves + 1;
+}
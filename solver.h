@@ -0,0 +1,46 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "bitboard.h"
+
+/* Scores follow the usual Connect Four solver convention: 0 is a draw, a
+ * positive score means the side to move wins, and the sooner the win the
+ * bigger the score (one point per stone the winner has left unplayed). */
+#define SOLVER_MIN_SCORE (-(rows * cols) / 2 + 3)
+#define SOLVER_MAX_SCORE ((rows * cols + 1) / 2 - 3)
+
+#define SOLVER_DEFAULT_BITS 23
+
+typedef struct {
+    uint64_t *keys;
+    int8_t *values;     /* 0 = empty, otherwise an encoded bound */
+    int8_t *moves;      /* the column behind a lower bound, -1 for none */
+    size_t mask;
+} SolverTable;
+
+typedef struct {
+    SolverTable table;
+    long long nodes;
+    atomic_bool *stop;  /* optional; once set, solve() unwinds and its result is void */
+    long long deadline; /* monotonic ns at which to set *stop, 0 for none */
+} Solver;
+
+bool solverInit(Solver *s, int bits);
+void solverFree(Solver *s);
+void solverReset(Solver *s);
+bool solverStopped(Solver *s);
+
+/* exact score of pos; with weak set only its sign (-1, 0, 1) is exact */
+int solve(Solver *s, const Position *pos, bool weak);
+
+/* best column for the side to move and its exact score, -1 if stopped */
+int solverBestMove(Solver *s, const Position *pos, int *score);
+
+/* plies until the game ends when both sides play perfectly; for a draw,
+ * the number of empty cells */
+int solverPliesToEnd(const Position *pos, int score);
+
+#endif
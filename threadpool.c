@@ -0,0 +1,93 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "threadpool.h"
+
+static void *poolMain(void *arg) {
+    ThreadPool *pool = arg;
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (pool->queued == 0 && !pool->quit) pthread_cond_wait(&pool->jobReady, &pool->lock);
+        if (pool->queued == 0) break;
+
+        PoolJob job = pool->queue[pool->head];
+        pool->head = (pool->head + 1) % POOL_QUEUE_SIZE;
+        pool->queued--;
+        pool->running++;
+        pthread_mutex_unlock(&pool->lock);
+        job.fn(job.arg);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0 && pool->queued == 0) pthread_cond_broadcast(&pool->allDone);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/* best effort: a thread that cannot be pinned still runs */
+static void pinThread(pthread_t thread, int cpu) {
+#ifdef __linux__
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % n, &set);
+    pthread_setaffinity_np(thread, sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+bool poolInit(ThreadPool *pool, int threads, int pinFrom) {
+    *pool = (ThreadPool){0};
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->jobReady, NULL);
+    pthread_cond_init(&pool->allDone, NULL);
+    if (threads <= 0) return true;
+
+    pool->threads = malloc(threads * sizeof(pthread_t));
+    if (!pool->threads) return false;
+    for (; pool->threadCount < threads; pool->threadCount++) {
+        pthread_t *t = &pool->threads[pool->threadCount];
+        if (pthread_create(t, NULL, poolMain, pool) != 0) break;
+        if (pinFrom >= 0) pinThread(*t, pinFrom + pool->threadCount);
+    }
+    if (pool->threadCount == threads) return true;
+    poolFree(pool);
+    return false;
+}
+
+/* lets queued jobs finish, then stops every thread */
+void poolFree(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->jobReady);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->threadCount; i++) pthread_join(pool->threads[i], NULL);
+    free(pool->threads);
+    pool->threads = NULL;
+    pool->threadCount = 0;
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->jobReady);
+    pthread_cond_destroy(&pool->allDone);
+}
+
+bool poolSubmit(ThreadPool *pool, PoolJobFn fn, void *arg) {
+    pthread_mutex_lock(&pool->lock);
+    bool ok = pool->queued < POOL_QUEUE_SIZE;
+    if (ok) {
+        pool->queue[(pool->head + pool->queued) % POOL_QUEUE_SIZE] = (PoolJob){ fn, arg };
+        pool->queued++;
+        pthread_cond_signal(&pool->jobReady);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return ok;
+}
+
+void poolWait(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->queued > 0 || pool->running > 0) pthread_cond_wait(&pool->allDone, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,41 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#define POOL_QUEUE_SIZE 256
+
+typedef void (*PoolJobFn)(void *arg);
+
+typedef struct {
+    PoolJobFn fn;
+    void *arg;
+} PoolJob;
+
+/* Threads started once and kept for the whole process; jobs run in the
+ * order they were submitted, on whichever thread is free first. */
+typedef struct {
+    pthread_t *threads;
+    int threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t jobReady;
+    pthread_cond_t allDone;
+    PoolJob queue[POOL_QUEUE_SIZE];
+    int head;                   /* queue[head] is the oldest waiting job */
+    int queued;
+    int running;                /* jobs taken off the queue but not finished */
+    bool quit;
+} ThreadPool;
+
+/* pinFrom >= 0 pins thread i to CPU (pinFrom + i) modulo the CPU count */
+bool poolInit(ThreadPool *pool, int threads, int pinFrom);
+void poolFree(ThreadPool *pool);
+
+/* false if the queue is full */
+bool poolSubmit(ThreadPool *pool, PoolJobFn fn, void *arg);
+
+/* blocks until every job submitted so far has finished */
+void poolWait(ThreadPool *pool);
+
+#endif
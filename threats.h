@@ -0,0 +1,65 @@
+#ifndef THREATS_H
+#define THREATS_H
+
+#include "bitboard.h"
+
+/* ---------- Threat analysis ----------
+ * A threat is an empty cell that would complete a line for one side
+ * (winningCells). Threats that can be played right now are tactics; the
+ * search handles them by never generating a move that lets the opponent
+ * win at once (nonLosingMoves) and by giving up a node where every move
+ * does. The others decide the endgame by zugzwang: once the rest of the
+ * board is full, the first player ends up with the cells of rows 1, 3, 5
+ * (counting from 1 at the bottom) and the second player with rows 2, 4, 6,
+ * so a threat is only worth much on its owner's parity, and a threat is
+ * dead while the opponent has one lower in the same column. */
+
+#define THREAT_PARITY_WEIGHT 60     /* live threat on its owner's parity */
+#define THREAT_OTHER_WEIGHT 10      /* live threat on the other parity */
+
+/* one bit per column that has a cell in cells */
+static inline unsigned cellColumns(bitboard cells) {
+    unsigned cs = 0;
+    for (int c = 0; c < cols; c++)
+        if (cells & columnMask(c)) cs |= 1u << c;
+    return cs;
+}
+
+/* cells on the rows colour ends up with by zugzwang: rows 0, 2, 4 of the
+ * bitboard for the first player (colour 0), rows 1, 3, 5 for the second.
+ * With an odd number of rows the parity argument does not hold, so no
+ * row is either side's and every live threat weighs the same. */
+static inline bitboard parityRows(int colour) {
+    bitboard b = 0;
+#if rows % 2 == 0
+    for (int r = colour; r < rows; r += 2) b |= bottomMask() << r;
+#else
+    (void)colour;
+#endif
+    return b;
+}
+
+/* every cell above one of cells, in the same column; a step at a time,
+ * so the empty bit on top of each column stops the fill */
+static inline bitboard cellsAbove(bitboard cells) {
+    bitboard above = 0;
+    for (int k = 1; k < rows; k++) {
+        cells = (cells << 1) & boardMask();
+        above |= cells;
+    }
+    return above;
+}
+
+/* Zugzwang term for own stones of the given colour against the other
+ * side's, with mask every occupied cell, from own's point of view. */
+static inline int threatScore(bitboard own, bitboard other, bitboard mask, int colour) {
+    bitboard ownThreats = winningCells(own, mask);
+    bitboard otherThreats = winningCells(other, mask);
+    bitboard ownLive = ownThreats & ~cellsAbove(otherThreats);
+    bitboard otherLive = otherThreats & ~cellsAbove(ownThreats);
+    bitboard ownRows = parityRows(colour), otherRows = parityRows(!colour);
+    return THREAT_PARITY_WEIGHT * (bbPopcount(ownLive & ownRows) - bbPopcount(otherLive & otherRows)) +
+           THREAT_OTHER_WEIGHT * (bbPopcount(ownLive & ~ownRows) - bbPopcount(otherLive & ~otherRows));
+}
+
+#endif
@@ -0,0 +1,12 @@
+#include <string.h>
+
+#include "variant.h"
+
+const Variant *const variants[] = { &variant_7x6, &variant_8x7, &variant_9x7, &variant_10x8, &variant_9x6c5 };
+const int variantCount = sizeof(variants) / sizeof(variants[0]);
+
+const Variant *variantFind(const char *name) {
+    for (int i = 0; i < variantCount; i++)
+        if (strcmp(variants[i]->name, name) == 0) return variants[i];
+    return NULL;
+}
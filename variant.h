@@ -0,0 +1,40 @@
+#ifndef VARIANT_H
+#define VARIANT_H
+
+#include <stdbool.h>
+
+/* ---------- Board variants ----------
+ * The engine takes its board geometry from compile-time constants, so
+ * every variant is engine.c and eval.c compiled again with its own rows,
+ * cols and CONNECT (variantengine.h): masks, window tables and loop bounds
+ * are constants and nothing is sized at runtime. A game picks a variant
+ * by name. Positions cross this interface as the columns played so far,
+ * so callers need no geometry-sized types. */
+
+enum { VARIANT_PLAYING, VARIANT_WON, VARIANT_DRAWN, VARIANT_ILLEGAL };
+
+typedef struct {
+    int bestCol;                /* -1 if the game is over or the moves are illegal */
+    int score;
+    int depth;
+    long long nodes;
+} VariantResult;
+
+typedef struct {
+    const char *name;           /* columns x rows, then "c5" if lines of five win */
+    int boardRows, boardCols, connect;
+    bool (*init)(void);         /* tables and a transposition table; false without memory */
+    void (*release)(void);
+    int (*status)(const int *moves, int count);     /* VARIANT_* after the last move */
+    VariantResult (*search)(const int *moves, int count, int budgetMs);
+} Variant;
+
+extern const Variant variant_7x6, variant_8x7, variant_9x7, variant_10x8, variant_9x6c5;
+
+extern const Variant *const variants[];
+extern const int variantCount;
+
+/* NULL if there is no variant of that name */
+const Variant *variantFind(const char *name);
+
+#endif
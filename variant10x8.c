@@ -0,0 +1,7 @@
+/* 10 columns, 8 rows, four in a row, on 128-bit boards. */
+#define rows 8
+#define cols 10
+#define CONNECT 4
+#define VARIANT_ID 10x8
+
+#include "variantengine.h"
@@ -0,0 +1,7 @@
+/* The standard board: 7 columns, 6 rows, four in a row. */
+#define rows 6
+#define cols 7
+#define CONNECT 4
+#define VARIANT_ID 7x6
+
+#include "variantengine.h"
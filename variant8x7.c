@@ -0,0 +1,7 @@
+/* 8 columns, 7 rows, four in a row; the board fills all 64 bits. */
+#define rows 7
+#define cols 8
+#define CONNECT 4
+#define VARIANT_ID 8x7
+
+#include "variantengine.h"
@@ -0,0 +1,7 @@
+/* Connect-5: 9 columns, 6 rows, five in a row. */
+#define rows 6
+#define cols 9
+#define CONNECT 5
+#define VARIANT_ID 9x6c5
+
+#include "variantengine.h"
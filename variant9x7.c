@@ -0,0 +1,7 @@
+/* 9 columns, 7 rows, four in a row, on 128-bit boards. */
+#define rows 7
+#define cols 9
+#define CONNECT 4
+#define VARIANT_ID 9x7
+
+#include "variantengine.h"
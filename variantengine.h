@@ -0,0 +1,100 @@
+/* One board variant's engine. Not a normal header: a variant file defines
+ * rows, cols, CONNECT and VARIANT_ID (the name as a token, like 9x7),
+ * then includes this once. Every global of engine.c and eval.c gets the
+ * id as a suffix so the variants link into one binary side by side. */
+
+#if !defined(rows) || !defined(cols) || !defined(CONNECT) || !defined(VARIANT_ID)
+#error "define rows, cols, CONNECT and VARIANT_ID before including variantengine.h"
+#endif
+
+#define VARIANT_PASTE(name, id) name##_##id
+#define VARIANT_SYMBOL(name, id) VARIANT_PASTE(name, id)
+#define VARIANT_QUOTE(id) #id
+#define VARIANT_STRING(id) VARIANT_QUOTE(id)
+
+#define centerOrder VARIANT_SYMBOL(centerOrder, VARIANT_ID)
+#define zobristKeys VARIANT_SYMBOL(zobristKeys, VARIANT_ID)
+#define engineInit VARIANT_SYMBOL(engineInit, VARIANT_ID)
+#define ttInit VARIANT_SYMBOL(ttInit, VARIANT_ID)
+#define ttFree VARIANT_SYMBOL(ttFree, VARIANT_ID)
+#define ttClear VARIANT_SYMBOL(ttClear, VARIANT_ID)
+#define ttProbe VARIANT_SYMBOL(ttProbe, VARIANT_ID)
+#define monotonicNs VARIANT_SYMBOL(monotonicNs, VARIANT_ID)
+#define deadlineAfterMs VARIANT_SYMBOL(deadlineAfterMs, VARIANT_ID)
+#define searchStopped VARIANT_SYMBOL(searchStopped, VARIANT_ID)
+#define searchInit VARIANT_SYMBOL(searchInit, VARIANT_ID)
+#define minimax VARIANT_SYMBOL(minimax, VARIANT_ID)
+#define negamax VARIANT_SYMBOL(negamax, VARIANT_ID)
+#define searchSibling VARIANT_SYMBOL(searchSibling, VARIANT_ID)
+#define iterativeDeepening VARIANT_SYMBOL(iterativeDeepening, VARIANT_ID)
+#define searchStatsAdd VARIANT_SYMBOL(searchStatsAdd, VARIANT_ID)
+#define searchStatsPrint VARIANT_SYMBOL(searchStatsPrint, VARIANT_ID)
+#define windows VARIANT_SYMBOL(windows, VARIANT_ID)
+#define windowScore VARIANT_SYMBOL(windowScore, VARIANT_ID)
+#define evalTablesInit VARIANT_SYMBOL(evalTablesInit, VARIANT_ID)
+#define scorePosition VARIANT_SYMBOL(scorePosition, VARIANT_ID)
+#define scorePositionWindows VARIANT_SYMBOL(scorePositionWindows, VARIANT_ID)
+#define scorePositions VARIANT_SYMBOL(scorePositions, VARIANT_ID)
+#define evalKernelSupported VARIANT_SYMBOL(evalKernelSupported, VARIANT_ID)
+#define evalBestKernel VARIANT_SYMBOL(evalBestKernel, VARIANT_ID)
+#define evalSelectKernel VARIANT_SYMBOL(evalSelectKernel, VARIANT_ID)
+#define evalKernel VARIANT_SYMBOL(evalKernel, VARIANT_ID)
+#define evalKernelName VARIANT_SYMBOL(evalKernelName, VARIANT_ID)
+#define evalInit VARIANT_SYMBOL(evalInit, VARIANT_ID)
+#define evalPlay VARIANT_SYMBOL(evalPlay, VARIANT_ID)
+#define evalUndo VARIANT_SYMBOL(evalUndo, VARIANT_ID)
+
+#include "engine.c"
+#include "eval.c"
+#include "variant.h"
+
+static TranspositionTable variantTable;
+
+static bool variantInit(void) {
+    engineInit();
+    return variantTable.slots || ttInit(&variantTable, TT_DEFAULT_BITS);
+}
+
+static void variantRelease(void) { ttFree(&variantTable); }
+
+/* plays moves from the empty board; returns how many were legal, and a
+ * move after a win is not */
+static int variantReplay(Position *pos, const int *moves, int count, bool *won) {
+    positionInit(pos);
+    *won = false;
+    for (int i = 0; i < count; i++) {
+        if (*won || !canPlay(pos, moves[i])) return i;
+        *won = isWinningMove(pos, moves[i]);
+        playMove(pos, moves[i]);
+    }
+    return count;
+}
+
+static int variantStatus(const int *moves, int count) {
+    Position pos;
+    bool won;
+    if (variantReplay(&pos, moves, count, &won) < count) return VARIANT_ILLEGAL;
+    if (won) return VARIANT_WON;
+    return positionFull(&pos) ? VARIANT_DRAWN : VARIANT_PLAYING;
+}
+
+static VariantResult variantSearch(const int *moves, int count, int budgetMs) {
+    VariantResult result = { -1, 0, 0, 0 };
+    Position pos;
+    bool won;
+    if (variantReplay(&pos, moves, count, &won) < count || won || positionFull(&pos)) return result;
+
+    SearchContext ctx;
+    searchInit(&ctx, variantTable.slots ? &variantTable : NULL);
+    SearchResult r = iterativeDeepening(&ctx, &pos, MAX_DEPTH, budgetMs);
+    result.bestCol = r.bestCol;
+    result.score = r.score;
+    result.depth = r.depth;
+    result.nodes = ctx.nodes;
+    return result;
+}
+
+const Variant VARIANT_SYMBOL(variant, VARIANT_ID) = {
+    VARIANT_STRING(VARIANT_ID), rows, cols, CONNECT,
+    variantInit, variantRelease, variantStatus, variantSearch
+};